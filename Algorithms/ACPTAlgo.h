@@ -21,6 +21,8 @@
 #include "lardataobj/RecoBase/PFParticle.h"
 #include "larpandora/LArPandoraInterface/LArPandoraHelper.h"
 
+#include "TrackSummaryTable.h"
+
 namespace ubxsec{
   
   /**
@@ -54,6 +56,9 @@ namespace ubxsec{
     /// Sets the TPC object
     void SetVtx(recob::Vertex);
 
+    /// Sets the track table used for lengths, end points and directions (optional, not owned)
+    void SetTrackSummaries(const TrackSummaryTable * summaries) { _summaries = summaries; }
+
     /// Restores flags
     void Clear();
 
@@ -74,7 +79,7 @@ namespace ubxsec{
     double xyz[3]; ///< will store vertex location
     TVector3 start, end; ///< will store track start and end
     double dist; ///< will store track distance
-    std::vector<recob::Track> keep_track; ///< will store tracks to be kept for calculation
+    const TrackSummaryTable * _summaries = nullptr; ///< track table, if set
     std::vector<TVector3> track_dir; ///< will store the track direction (always away from the vertex) to calcuate the angle
 
   };
@@ -0,0 +1,108 @@
+#ifndef ASYNCTREEWRITER_CXX
+#define ASYNCTREEWRITER_CXX
+
+#include "AsyncTreeWriter.h"
+
+#include "TROOT.h"
+
+namespace ubxsec {
+
+  std::mutex & TreeIOMutex()
+  {
+    static std::mutex io_mutex;
+    return io_mutex;
+  }
+
+  //___________________________________________________________________________________________________
+  void EnableROOTThreadSafety()
+  {
+    static std::once_flag flag;
+    std::call_once(flag, [] { ROOT::EnableThreadSafety(); });
+  }
+
+  //___________________________________________________________________________________________________
+  void AsyncTreeFiller::Init(TTree * tree, bool async)
+  {
+    Stop();
+
+    _tree = tree;
+    _async = async;
+
+    if (_async) {
+      _pending = _stop = false;
+      _thread = std::thread(&AsyncTreeFiller::Run, this);
+    }
+  }
+
+  //___________________________________________________________________________________________________
+  void AsyncTreeFiller::Fill()
+  {
+    if (!_async) {
+      std::lock_guard<std::mutex> io_lock(TreeIOMutex());
+      if (_tree->Fill() < 0)
+        std::cerr << "[AsyncTreeFiller] Error filling tree " << _tree->GetName() << std::endl;
+      return;
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cv.wait(lock, [this] { return !_pending; });
+    _pending = true;
+
+    lock.unlock();
+    _cv.notify_all();
+  }
+
+  //___________________________________________________________________________________________________
+  void AsyncTreeFiller::Wait()
+  {
+    if (!_async) return;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cv.wait(lock, [this] { return !_pending; });
+  }
+
+  //___________________________________________________________________________________________________
+  void AsyncTreeFiller::Stop()
+  {
+    if (!_thread.joinable()) return;
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _cv.notify_all();
+
+    // The pending fill is done before the thread exits
+    _thread.join();
+  }
+
+  //___________________________________________________________________________________________________
+  void AsyncTreeFiller::Run()
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (true) {
+
+      _cv.wait(lock, [this] { return _pending || _stop; });
+
+      if (_pending) {
+        // The module does not touch the branch variables until Wait() returns
+        lock.unlock();
+        {
+          std::lock_guard<std::mutex> io_lock(TreeIOMutex());
+          if (_tree->Fill() < 0)
+            std::cerr << "[AsyncTreeFiller] Error filling tree " << _tree->GetName() << std::endl;
+        }
+        lock.lock();
+
+        _pending = false;
+        _cv.notify_all();
+        continue;
+      }
+
+      if (_stop) return;
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,287 @@
+/**
+ * \file AsyncTreeWriter.h
+ *
+ * \ingroup UBXSec
+ *
+ * \brief Classes filling TTrees on a background thread
+ *
+ * @author Marco Del Tutto
+ */
+
+/** \addtogroup UBXSec
+
+    @{*/
+
+#ifndef ASYNCTREEWRITER_H
+#define ASYNCTREEWRITER_H
+
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <vector>
+
+#include "TTree.h"
+
+namespace ubxsec {
+
+  /**
+   *  @brief Mutex held around every write to the TFileService file in the package
+   *
+   *  All the trees and histograms of the package go to the same file, and
+   *  the async writers fill them from their own threads. Modules from other
+   *  packages writing to the same file do not take this lock, so the async
+   *  writing should only be turned on in jobs where the package modules
+   *  are the only ones filling TFileService objects during the event loop.
+   */
+  std::mutex & TreeIOMutex();
+
+  /**
+   *  @brief Calls ROOT::EnableThreadSafety(), once per job
+   *
+   *  Has to be called before any ROOT object is made by the module, i.e. at
+   *  the start of the constructor of the modules that write asynchronously.
+   */
+  void EnableROOTThreadSafety();
+
+  /**
+   * \class AsyncTreeWriter
+   *
+   * Fills a tree from a bounded queue of records. The module sets the
+   * record returned by Get(), and Commit() moves it to the queue, which a
+   * background thread writes to the tree (compression and basket writing
+   * included), so the module can move on. Commit() only waits when
+   * queue_depth records are already in flight: the memory used is
+   * queue_depth + 2 records.
+   *
+   * After Commit(), Get() returns an older record: all the fields have to
+   * be set before every Commit().
+   *
+   * Record needs to be default constructible, swappable, and to have a
+   * Branch(TTree*, int basket_size) function creating the branches on its
+   * own members. With async set to false the branches point to the record
+   * returned by Get() and the tree is filled in Commit(), without copies.
+   * Flush() has to be called at the end of the job, before the file is
+   * written.
+   */
+  template <class Record>
+  class AsyncTreeWriter {
+
+  public:
+
+    /// Default constructor, Init has to be called before use
+    AsyncTreeWriter() = default;
+
+    /// Destructor, writes the pending records and stops the thread
+    ~AsyncTreeWriter() { Stop(); }
+
+    AsyncTreeWriter(AsyncTreeWriter const &) = delete;
+    AsyncTreeWriter & operator = (AsyncTreeWriter const &) = delete;
+
+    /**
+     *  @brief Creates the branches and, if async, starts the writing thread
+     *
+     *  @param tree the tree to fill
+     *  @param async if true, the tree is filled on a background thread
+     *  @param basket_size the basket size of the branches
+     *  @param queue_depth the maximum number of committed records not yet in the tree
+     */
+    void Init(TTree * tree, bool async, int basket_size = 32000, size_t queue_depth = 64);
+
+    /// Returns the record to be filled for the next entry
+    Record & Get() { return _fill; }
+
+    /// Writes the record returned by Get() to the tree
+    void Commit();
+
+    /// Waits until the committed records are in the tree
+    void Flush();
+
+  private:
+
+    /// Flushes and stops the writing thread
+    void Stop();
+
+    /// Fills the tree from the record the branches point to
+    void FillTree();
+
+    /// Writing thread
+    void Run();
+
+    TTree * _tree = nullptr;
+    bool _async = false;
+
+    Record _fill;                ///< Set by the module (the branches point here if not async)
+    Record _write;               ///< The branches point here if async
+    std::vector<Record> _queue;  ///< Committed records, ring buffer
+
+    std::thread _thread;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    size_t _head = 0;      ///< Queue slot of the oldest committed record
+    size_t _count = 0;     ///< Number of committed records in the queue
+    bool _busy = false;    ///< True while the writing thread fills the tree
+    bool _stop = false;    ///< Tells the writing thread to exit
+  };
+
+  /**
+   * \class AsyncTreeFiller
+   *
+   * Fills a tree whose branches point to the module members. With async
+   * set, Fill() returns immediately and the tree is filled on a background
+   * thread, while the module is done with the event and the framework
+   * moves to the next one. The members must not be changed until the fill
+   * is over: Wait() has to be called before the module touches them, i.e.
+   * at the start of every event and at the end of the job. Without async,
+   * Fill() fills the tree and Wait() does nothing.
+   */
+  class AsyncTreeFiller {
+
+  public:
+
+    /// Default constructor, Init has to be called before use
+    AsyncTreeFiller() = default;
+
+    /// Destructor, waits for the pending fill and stops the thread
+    ~AsyncTreeFiller() { Stop(); }
+
+    AsyncTreeFiller(AsyncTreeFiller const &) = delete;
+    AsyncTreeFiller & operator = (AsyncTreeFiller const &) = delete;
+
+    /// Sets the tree and, if async, starts the filling thread
+    void Init(TTree * tree, bool async);
+
+    /// Fills the tree, on the background thread if async
+    void Fill();
+
+    /// Waits until the last Fill() is over
+    void Wait();
+
+  private:
+
+    /// Waits and stops the filling thread
+    void Stop();
+
+    /// Filling thread
+    void Run();
+
+    TTree * _tree = nullptr;
+    bool _async = false;
+
+    std::thread _thread;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    bool _pending = false;  ///< True until the requested fill is over
+    bool _stop = false;     ///< Tells the filling thread to exit
+  };
+
+  //___________________________________________________________________________________________________
+  template <class Record>
+  void AsyncTreeWriter<Record>::Init(TTree * tree, bool async, int basket_size, size_t queue_depth)
+  {
+    Stop();
+
+    _tree = tree;
+    _async = async;
+
+    if (!_async) {
+      _fill.Branch(_tree, basket_size);
+      return;
+    }
+
+    _write.Branch(_tree, basket_size);
+    _queue.resize(queue_depth > 0 ? queue_depth : 1);
+    _head = _count = 0;
+    _busy = _stop = false;
+    _thread = std::thread(&AsyncTreeWriter<Record>::Run, this);
+  }
+
+  //___________________________________________________________________________________________________
+  template <class Record>
+  void AsyncTreeWriter<Record>::Commit()
+  {
+    if (!_async) {
+      FillTree();
+      return;
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cv.wait(lock, [this] { return _count < _queue.size(); });
+
+    std::swap(_fill, _queue[(_head + _count) % _queue.size()]);
+    _count++;
+
+    lock.unlock();
+    _cv.notify_all();
+  }
+
+  //___________________________________________________________________________________________________
+  template <class Record>
+  void AsyncTreeWriter<Record>::Flush()
+  {
+    if (!_async) return;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cv.wait(lock, [this] { return _count == 0 && !_busy; });
+  }
+
+  //___________________________________________________________________________________________________
+  template <class Record>
+  void AsyncTreeWriter<Record>::Stop()
+  {
+    if (!_thread.joinable()) return;
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _cv.notify_all();
+
+    // The queued records are written before the thread exits
+    _thread.join();
+  }
+
+  //___________________________________________________________________________________________________
+  template <class Record>
+  void AsyncTreeWriter<Record>::FillTree()
+  {
+    std::lock_guard<std::mutex> io_lock(TreeIOMutex());
+
+    if (_tree->Fill() < 0)
+      std::cerr << "[AsyncTreeWriter] Error filling tree " << _tree->GetName() << std::endl;
+  }
+
+  //___________________________________________________________________________________________________
+  template <class Record>
+  void AsyncTreeWriter<Record>::Run()
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (true) {
+
+      _cv.wait(lock, [this] { return _count > 0 || _stop; });
+
+      if (_count > 0) {
+        // Takes the oldest record, its slot is free for Commit() again
+        std::swap(_write, _queue[_head]);
+        _head = (_head + 1) % _queue.size();
+        _count--;
+        _busy = true;
+        _cv.notify_all();
+
+        lock.unlock();
+        FillTree();
+        lock.lock();
+
+        _busy = false;
+        _cv.notify_all();
+        continue;
+      }
+
+      if (_stop) return;
+    }
+  }
+}
+
+#endif //  ASYNCTREEWRITER_H
+/** @} */ // end of doxygen group
@@ -0,0 +1,64 @@
+#ifndef BACKTRACKERCACHE_CXX
+#define BACKTRACKERCACHE_CXX
+
+#include "BackTrackerCache.h"
+
+namespace ubxsec {
+
+  void BackTrackerCache::Clear()
+  {
+    _hit_to_eveids.clear();
+    _trackid_to_energy.clear();
+    _trackid_to_mctruth.clear();
+  }
+
+  //___________________________________________________________________________________________________
+  cheat::BackTracker & BackTrackerCache::BT()
+  {
+    if (!_bt) _bt = &*art::ServiceHandle<cheat::BackTracker>();
+    return *_bt;
+  }
+
+  //___________________________________________________________________________________________________
+  std::vector<sim::TrackIDE> const & BackTrackerCache::HitToEveID(art::Ptr<recob::Hit> const & hit)
+  {
+    auto it = _hit_to_eveids.find(hit);
+    if (it != _hit_to_eveids.end()) return it->second;
+
+    return _hit_to_eveids.emplace(hit, BT().HitToEveID(hit)).first->second;
+  }
+
+  //___________________________________________________________________________________________________
+  double BackTrackerCache::TrackIDToTotalEnergy(int trackid)
+  {
+    auto it = _trackid_to_energy.find(trackid);
+    if (it != _trackid_to_energy.end()) return it->second;
+
+    double energy = 0;
+    for (const sim::IDE & ide : BT().TrackIDToSimIDE(trackid)) {
+      energy += ide.energy;
+    }
+
+    _trackid_to_energy[trackid] = energy;
+    return energy;
+  }
+
+  //___________________________________________________________________________________________________
+  art::Ptr<simb::MCTruth> const & BackTrackerCache::TrackIDToMCTruth(int trackid)
+  {
+    auto it = _trackid_to_mctruth.find(trackid);
+    if (it != _trackid_to_mctruth.end()) return it->second;
+
+    return _trackid_to_mctruth.emplace(trackid, BT().TrackIDToMCTruth(trackid)).first->second;
+  }
+
+  //___________________________________________________________________________________________________
+  simb::Origin_t BackTrackerCache::TrackIDToOrigin(int trackid)
+  {
+    art::Ptr<simb::MCTruth> const & mc_truth = TrackIDToMCTruth(trackid);
+    if (!mc_truth) return simb::kUnknown;
+    return mc_truth->Origin();
+  }
+}
+
+#endif
@@ -0,0 +1,81 @@
+/**
+ * \file BackTrackerCache.h
+ *
+ * \ingroup UBXSec
+ *
+ * \brief Event-scoped cache of the BackTracker results
+ *
+ * @author Marco Del Tutto
+ */
+
+/** \addtogroup UBXSec
+
+    @{*/
+
+#ifndef BACKTRACKERCACHE_H
+#define BACKTRACKERCACHE_H
+
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "canvas/Persistency/Common/Ptr.h"
+#include "lardataobj/RecoBase/Hit.h"
+#include "nusimdata/SimulationBase/MCTruth.h"
+#include "larsim/MCCheater/BackTracker.h"
+
+namespace ubxsec {
+
+  /**
+   * \class BackTrackerCache
+   *
+   * Memoizes the BackTracker queries used in the analysis: hit to eve
+   * IDs (track ID and energy), and, per track ID, the total deposited
+   * energy, the MCTruth and its origin. Each entry is computed from the
+   * BackTracker service the first time it is asked for. Build one per
+   * event, or call Clear at the start of each event.
+   *
+   * The service handle is only created by the first query, so a cache
+   * that is never queried does not need the BackTracker to be configured.
+   */
+  class BackTrackerCache {
+
+  public:
+
+    /// Default constructor
+    BackTrackerCache() = default;
+
+    /// Default destructor
+    ~BackTrackerCache(){}
+
+    /// Empties the cache
+    void Clear();
+
+    /// Returns the eve IDs (track ID, energy, energy fraction) of the hit, as cheat::BackTracker::HitToEveID
+    std::vector<sim::TrackIDE> const & HitToEveID(art::Ptr<recob::Hit> const & hit);
+
+    /// Returns the total energy deposited by the track ID, the sum of cheat::BackTracker::TrackIDToSimIDE
+    double TrackIDToTotalEnergy(int trackid);
+
+    /// Returns the MCTruth the track ID comes from, as cheat::BackTracker::TrackIDToMCTruth
+    art::Ptr<simb::MCTruth> const & TrackIDToMCTruth(int trackid);
+
+    /// Returns the origin of the MCTruth the track ID comes from, simb::kUnknown if there is no MCTruth
+    simb::Origin_t TrackIDToOrigin(int trackid);
+
+  private:
+
+    /// Returns the BackTracker service, getting the handle on the first call
+    cheat::BackTracker & BT();
+
+    cheat::BackTracker * _bt = nullptr;
+
+    std::map<art::Ptr<recob::Hit>, std::vector<sim::TrackIDE>> _hit_to_eveids;  ///< Hit -> eve IDs
+    std::map<int, double>                                      _trackid_to_energy; ///< Track ID -> total deposited energy
+    std::map<int, art::Ptr<simb::MCTruth>>                     _trackid_to_mctruth; ///< Track ID -> MCTruth
+  };
+}
+
+#endif //  BACKTRACKERCACHE_H
+/** @} */ // end of doxygen group
@@ -0,0 +1,85 @@
+#ifndef CHARGEMOMENTTABLE_CXX
+#define CHARGEMOMENTTABLE_CXX
+
+#include "ChargeMomentTable.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ubxsec {
+
+  ChargeMoments & ChargeMoments::operator+=(ChargeMoments const & other)
+  {
+    n_points += other.n_points;
+    q   += other.q;
+    qx  += other.qx;  qy  += other.qy;  qz  += other.qz;
+    qxx += other.qxx; qyy += other.qyy; qzz += other.qzz;
+    return *this;
+  }
+
+  //___________________________________________________________________________________________________
+  void ChargeMoments::Center(double * xyz) const
+  {
+    xyz[0] = qx / q;
+    xyz[1] = qy / q;
+    xyz[2] = qz / q;
+  }
+
+  //___________________________________________________________________________________________________
+  void ChargeMoments::Width(double * sigma) const
+  {
+    double center[3];
+    Center(center);
+
+    // Rounding can make the variance slightly negative for a single point
+    sigma[0] = std::sqrt(std::max(0., qxx / q - center[0] * center[0]));
+    sigma[1] = std::sqrt(std::max(0., qyy / q - center[1] * center[1]));
+    sigma[2] = std::sqrt(std::max(0., qzz / q - center[2] * center[2]));
+  }
+
+  //___________________________________________________________________________________________________
+  void ChargeMomentTable::Fill(lar_pandora::PFParticlesToSpacePoints const & pfp_to_spacepoints,
+                               lar_pandora::SpacePointsToHits const & spacepoints_to_hits)
+  {
+    Clear();
+
+    size_t max_key = 0;
+    for (auto const & iter : pfp_to_spacepoints) max_key = std::max(max_key, iter.first.key());
+    if (!pfp_to_spacepoints.empty()) {
+      _table.resize(max_key + 1);
+      _filled.resize(max_key + 1, 0);
+    }
+
+    int n_no_hit = 0;
+
+    for (auto const & iter : pfp_to_spacepoints) {
+
+      _filled[iter.first.key()] = 1;
+      ChargeMoments & m = _table[iter.first.key()];
+
+      for (auto const & sp_pt : iter.second) {
+
+        auto iter2 = spacepoints_to_hits.find(sp_pt);
+        if (iter2 == spacepoints_to_hits.end()) {
+          n_no_hit++;
+          continue;
+        }
+
+        double q = iter2->second->Integral();
+        double x = sp_pt->XYZ()[0];
+        double y = sp_pt->XYZ()[1];
+        double z = sp_pt->XYZ()[2];
+
+        m.n_points++;
+        m.q   += q;
+        m.qx  += q * x;     m.qy  += q * y;     m.qz  += q * z;
+        m.qxx += q * x * x; m.qyy += q * y * y; m.qzz += q * z * z;
+      }
+    }
+
+    if (n_no_hit > 0)
+      std::cout << "[ChargeMomentTable] Can't find hits ass to " << n_no_hit << " sp_pt." << std::endl;
+  }
+}
+
+#endif
@@ -0,0 +1,86 @@
+/**
+ * \file ChargeMomentTable.h
+ *
+ * \ingroup UBXSec
+ *
+ * \brief Per-PFParticle charge moments of the spacepoints, for charge centers and widths
+ *
+ * @author Marco Del Tutto
+ */
+
+/** \addtogroup UBXSec
+
+    @{*/
+
+#ifndef CHARGEMOMENTTABLE_H
+#define CHARGEMOMENTTABLE_H
+
+#include <iostream>
+#include <vector>
+
+#include "larpandora/LArPandoraInterface/LArPandoraHelper.h"
+
+namespace ubxsec {
+
+  /// Charge weighted sums of the spacepoint positions, the charge being the integral of the spacepoint hit
+  struct ChargeMoments {
+    int    n_points = 0;                  ///< Number of spacepoints with a hit
+    double q = 0.;                        ///< Sum of q
+    double qx = 0., qy = 0., qz = 0.;     ///< Sums of q*x, q*y, q*z
+    double qxx = 0., qyy = 0., qzz = 0.;  ///< Sums of q*x*x, q*y*y, q*z*z
+
+    /// Adds the moments of another object (e.g. to sum the PFPs of a slice)
+    ChargeMoments & operator+=(ChargeMoments const & other);
+
+    /// Sets xyz to the charge center (NaN if there is no charge)
+    void Center(double * xyz) const;
+
+    /// Sets sigma to the charge weighted RMS along x, y and z (NaN if there is no charge)
+    void Width(double * sigma) const;
+  };
+
+  /**
+   * \class ChargeMomentTable
+   *
+   * Built in one pass over the PFP -> spacepoints and spacepoint -> hit
+   * maps, stores the charge moments of each PFParticle in a table indexed
+   * by the art::Ptr key of the PFP. The center and width of a group of PFPs
+   * (a slice) are then computed from the sum (operator+=) of their entries,
+   * without collecting the spacepoints again.
+   */
+  class ChargeMomentTable {
+
+  public:
+
+    /// Default constructor
+    ChargeMomentTable() = default;
+
+    /// Default destructor
+    ~ChargeMomentTable(){}
+
+    /// Fills the table
+    void Fill(lar_pandora::PFParticlesToSpacePoints const & pfp_to_spacepoints,
+              lar_pandora::SpacePointsToHits const & spacepoints_to_hits);
+
+    /// Returns true if the PFP with key passed has spacepoints
+    bool Has(size_t key) const { return key < _filled.size() && _filled[key]; }
+
+    /// Returns the moments for the PFP with key passed (all zeros if not in the table)
+    ChargeMoments const & Get(size_t key) const { return (key < _table.size() ? _table[key] : _empty); }
+
+    /// Returns the size of the table (max key + 1)
+    size_t size() const { return _table.size(); }
+
+    /// Empties the table
+    void Clear() { _table.clear(); _filled.clear(); }
+
+  private:
+
+    std::vector<ChargeMoments> _table; ///< Indexed by the art::Ptr key
+    std::vector<char> _filled;         ///< True if the PFP has spacepoints
+    ChargeMoments _empty;              ///< Returned for keys not in the table
+  };
+}
+
+#endif //  CHARGEMOMENTTABLE_H
+/** @} */ // end of doxygen group
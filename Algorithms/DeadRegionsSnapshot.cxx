@@ -0,0 +1,220 @@
+#ifndef DEADREGIONSSNAPSHOT_CXX
+#define DEADREGIONSSNAPSHOT_CXX
+
+#include "DeadRegionsSnapshot.h"
+
+#include <fstream>
+#include <cstdlib>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ubxsec {
+
+  DeadRegionsSnapshot::~DeadRegionsSnapshot()
+  {
+    Close();
+  }
+
+  //___________________________________________________________________________________________________
+  void DeadRegionsSnapshot::Close()
+  {
+    if (_data != nullptr) munmap(_data, _size);
+
+    _data = nullptr;
+    _size = 0;
+    _n_channels = 0;
+    _wire = nullptr;
+    _y_start = _z_start = _y_end = _z_end = nullptr;
+    _status = nullptr;
+  }
+
+  //___________________________________________________________________________________________________
+  bool DeadRegionsSnapshot::Open(std::string file_name)
+  {
+    Close();
+
+    int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) {
+      std::cerr << "[DeadRegionsSnapshot] Cannot open file " << file_name << std::endl;
+      return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(DeadRegionsSnapshotHeader)) {
+      std::cerr << "[DeadRegionsSnapshot] File " << file_name << " is too short." << std::endl;
+      close(fd);
+      return false;
+    }
+
+    void * data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED) {
+      std::cerr << "[DeadRegionsSnapshot] Cannot map file " << file_name << std::endl;
+      return false;
+    }
+
+    _data = data;
+    _size = st.st_size;
+
+    const DeadRegionsSnapshotHeader * header = static_cast<const DeadRegionsSnapshotHeader*>(_data);
+
+    if (header->magic != kMagic || header->version != kVersion) {
+      std::cerr << "[DeadRegionsSnapshot] File " << file_name << " is not a version " << kVersion << " snapshot." << std::endl;
+      Close();
+      return false;
+    }
+
+    size_t n = header->n_channels;
+    size_t expected_size = sizeof(DeadRegionsSnapshotHeader) + n * (sizeof(uint32_t) + 4 * sizeof(float) + sizeof(uint8_t));
+
+    if (_size != expected_size) {
+      std::cerr << "[DeadRegionsSnapshot] File " << file_name << " has size " << _size
+                << ", expected " << expected_size << "." << std::endl;
+      Close();
+      return false;
+    }
+
+    const char * ptr = static_cast<const char*>(_data) + sizeof(DeadRegionsSnapshotHeader);
+
+    _n_channels = n;
+    _wire    = reinterpret_cast<const uint32_t*>(ptr); ptr += n * sizeof(uint32_t);
+    _y_start = reinterpret_cast<const float*>(ptr);    ptr += n * sizeof(float);
+    _z_start = reinterpret_cast<const float*>(ptr);    ptr += n * sizeof(float);
+    _y_end   = reinterpret_cast<const float*>(ptr);    ptr += n * sizeof(float);
+    _z_end   = reinterpret_cast<const float*>(ptr);    ptr += n * sizeof(float);
+    _status  = reinterpret_cast<const uint8_t*>(ptr);
+
+    return true;
+  }
+
+  //___________________________________________________________________________________________________
+  bool DeadRegionsSnapshot::Write(std::string file_name,
+                                  std::vector<unsigned int> const& wire,
+                                  std::vector<float> const& y_start, std::vector<float> const& z_start,
+                                  std::vector<float> const& y_end, std::vector<float> const& z_end,
+                                  std::vector<bool> const& status)
+  {
+    size_t n = wire.size();
+
+    if (y_start.size() != n || z_start.size() != n || y_end.size() != n || z_end.size() != n || status.size() != n) {
+      std::cerr << "[DeadRegionsSnapshot] Geometry and status have different number of channels." << std::endl;
+      return false;
+    }
+
+    std::ofstream out(file_name, std::ios::binary);
+    if (!out.is_open()) {
+      std::cerr << "[DeadRegionsSnapshot] Cannot open file " << file_name << " for writing." << std::endl;
+      return false;
+    }
+
+    DeadRegionsSnapshotHeader header;
+    header.magic      = kMagic;
+    header.version    = kVersion;
+    header.n_channels = n;
+    header.reserved   = 0;
+
+    std::vector<uint32_t> wire_v(wire.begin(), wire.end());
+    std::vector<uint8_t> status_v(status.begin(), status.end());
+
+    out.write(reinterpret_cast<const char*>(&header),     sizeof(header));
+    out.write(reinterpret_cast<const char*>(wire_v.data()),  n * sizeof(uint32_t));
+    out.write(reinterpret_cast<const char*>(y_start.data()), n * sizeof(float));
+    out.write(reinterpret_cast<const char*>(z_start.data()), n * sizeof(float));
+    out.write(reinterpret_cast<const char*>(y_end.data()),   n * sizeof(float));
+    out.write(reinterpret_cast<const char*>(z_end.data()),   n * sizeof(float));
+    out.write(reinterpret_cast<const char*>(status_v.data()), n * sizeof(uint8_t));
+
+    return out.good();
+  }
+
+  //___________________________________________________________________________________________________
+  bool DeadRegionsSnapshot::ReadGeometryText(std::string file_name,
+                                             std::vector<unsigned int> & wire,
+                                             std::vector<float> & y_start, std::vector<float> & z_start,
+                                             std::vector<float> & y_end, std::vector<float> & z_end)
+  {
+    wire.clear();
+    y_start.clear();
+    z_start.clear();
+    y_end.clear();
+    z_end.clear();
+
+    std::ifstream geofile;
+    geofile.open(file_name);
+    if (!geofile.is_open()) {
+      std::cerr << "Problem opening file " << file_name << "." << std::endl;
+      return false;
+    }
+
+    std::string string_channel;
+    std::string string_plane;
+    std::string string_wire;
+    std::string string_sx;
+    std::string string_sy;
+    std::string string_sz;
+    std::string string_ex;
+    std::string string_ey;
+    std::string string_ez;
+
+    std::string dummy;
+
+    // Skip the header
+    for (int line = 0; line < 9; line++)
+      getline(geofile,dummy);
+
+    while(geofile >> string_channel)
+    {
+      geofile >> string_plane;
+      geofile >> string_wire;
+      geofile >> string_sx;
+      geofile >> string_sy;
+      geofile >> string_sz;
+      geofile >> string_ex;
+      geofile >> string_ey;
+      geofile >> string_ez;
+
+      wire.push_back(atoi(string_wire.c_str()));
+      y_start.push_back(atof(string_sy.c_str()));
+      z_start.push_back(atof(string_sz.c_str()));
+      y_end.push_back(atof(string_ey.c_str()));
+      z_end.push_back(atof(string_ez.c_str()));
+    }
+
+    geofile.close();
+
+    return true;
+  }
+
+  //___________________________________________________________________________________________________
+  bool DeadRegionsSnapshot::ReadStatusText(std::string file_name, std::vector<bool> & status)
+  {
+    status.clear();
+
+    std::ifstream chanstatfile;
+    chanstatfile.open(file_name);
+    if (!chanstatfile.is_open()) {
+      std::cerr << "Problem opening file " << file_name << "." << std::endl;
+      return false;
+    }
+
+    std::string string_CSchannel;
+    std::string string_CSstatus;
+
+    while(chanstatfile >> string_CSchannel)
+    {
+      chanstatfile >> string_CSstatus;
+
+      status.push_back(atoi(string_CSstatus.c_str()));
+    }
+
+    chanstatfile.close();
+
+    return true;
+  }
+}
+
+#endif
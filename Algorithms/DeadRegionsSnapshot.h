@@ -0,0 +1,107 @@
+/**
+ * \file DeadRegionsSnapshot.h
+ *
+ * \ingroup UBXSec
+ *
+ * \brief Binary snapshot of the wire geometry and channel statuses used by FindDeadRegions
+ *
+ * @author Marco Del Tutto
+ */
+
+/** \addtogroup UBXSec
+
+    @{*/
+
+#ifndef DEADREGIONSSNAPSHOT_H
+#define DEADREGIONSSNAPSHOT_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace ubxsec {
+
+  /**
+   * File layout (native endianness, version 1):
+   *
+   *   DeadRegionsSnapshotHeader
+   *   uint32_t wire[n_channels]
+   *   float    y_start[n_channels]
+   *   float    z_start[n_channels]
+   *   float    y_end[n_channels]
+   *   float    z_end[n_channels]
+   *   uint8_t  status[n_channels]  (1 = good, 0 = bad)
+   */
+  struct DeadRegionsSnapshotHeader {
+    uint32_t magic;      ///< Always kMagic
+    uint32_t version;    ///< Format version
+    uint32_t n_channels; ///< Number of channels
+    uint32_t reserved;   ///< Unused, keeps the arrays aligned
+  };
+
+  class DeadRegionsSnapshot {
+
+  public:
+
+    static const uint32_t kMagic   = 0x52444255; ///< "UBDR"
+    static const uint32_t kVersion = 1;
+
+    DeadRegionsSnapshot() = default;
+    ~DeadRegionsSnapshot();
+
+    DeadRegionsSnapshot(DeadRegionsSnapshot const &) = delete;
+    DeadRegionsSnapshot & operator = (DeadRegionsSnapshot const &) = delete;
+
+    /// Memory maps a snapshot file, returns false if the file cannot be read or has a wrong format
+    bool Open(std::string file_name);
+
+    /// Unmaps the file
+    void Close();
+
+    /// Returns true if a snapshot is mapped
+    bool IsOpen() const { return _data != nullptr; }
+
+    /// Returns the number of channels in the snapshot
+    uint32_t NChannels() const { return _n_channels; }
+
+    const uint32_t * Wire()   const { return _wire; }    ///< Wire number of each channel
+    const float * StartY()    const { return _y_start; } ///< Wire start y of each channel
+    const float * StartZ()    const { return _z_start; } ///< Wire start z of each channel
+    const float * EndY()      const { return _y_end; }   ///< Wire end y of each channel
+    const float * EndZ()      const { return _z_end; }   ///< Wire end z of each channel
+    const uint8_t * Status()  const { return _status; }  ///< Status (1 = good) of each channel
+
+    /// Writes a snapshot file, returns false on failure
+    static bool Write(std::string file_name,
+                      std::vector<unsigned int> const& wire,
+                      std::vector<float> const& y_start, std::vector<float> const& z_start,
+                      std::vector<float> const& y_end, std::vector<float> const& z_end,
+                      std::vector<bool> const& status);
+
+    /// Reads the wire geometry text file (ChannelWireGeometry_v2.txt format), returns false on failure
+    static bool ReadGeometryText(std::string file_name,
+                                 std::vector<unsigned int> & wire,
+                                 std::vector<float> & y_start, std::vector<float> & z_start,
+                                 std::vector<float> & y_end, std::vector<float> & z_end);
+
+    /// Reads the channel status text file (ChanStatus.txt format), returns false on failure
+    static bool ReadStatusText(std::string file_name, std::vector<bool> & status);
+
+  private:
+
+    void * _data = nullptr; ///< Start of the mapping
+    size_t _size = 0;       ///< Size of the mapping
+
+    uint32_t _n_channels = 0;
+    const uint32_t * _wire = nullptr;
+    const float * _y_start = nullptr;
+    const float * _z_start = nullptr;
+    const float * _y_end = nullptr;
+    const float * _z_end = nullptr;
+    const uint8_t * _status = nullptr;
+  };
+}
+
+#endif
+/** @} */ // end of doxygen group
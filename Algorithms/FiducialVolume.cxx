@@ -0,0 +1,100 @@
+#ifndef FIDUCIALVOLUME_CXX
+#define FIDUCIALVOLUME_CXX
+
+#include "FiducialVolume.h"
+
+#include <cmath>
+
+namespace ubxsec {
+
+  constexpr double MicroBooNEFVBox::x_min;
+  constexpr double MicroBooNEFVBox::x_max;
+  constexpr double MicroBooNEFVBox::y_min;
+  constexpr double MicroBooNEFVBox::y_max;
+  constexpr double MicroBooNEFVBox::z_min;
+  constexpr double MicroBooNEFVBox::z_max;
+
+  FiducialVolume::FiducialVolume(double x_min, double x_max, double y_min, double y_max, double z_min, double z_max)
+  {
+    _bounds.x_min = x_min;
+    _bounds.x_max = x_max;
+    _bounds.y_min = y_min;
+    _bounds.y_max = y_max;
+    _bounds.z_min = z_min;
+    _bounds.z_max = z_max;
+
+    // Edges read from FHiCL are rounded, compare with a tolerance
+    FVBounds def;
+    auto same = [](double a, double b) { return std::abs(a - b) < 1.e-6; };
+    _is_default = (same(x_min, def.x_min) && same(x_max, def.x_max) &&
+                   same(y_min, def.y_min) && same(y_max, def.y_max) &&
+                   same(z_min, def.z_min) && same(z_max, def.z_max));
+  }
+
+  //___________________________________________________________________________________________________
+  void FiducialVolume::Configure(fhicl::ParameterSet const& p)
+  {
+    FVBounds def;
+    *this = FiducialVolume(p.get<double>("XMin", def.x_min),
+                           p.get<double>("XMax", def.x_max),
+                           p.get<double>("YMin", def.y_min),
+                           p.get<double>("YMax", def.y_max),
+                           p.get<double>("ZMin", def.z_min),
+                           p.get<double>("ZMax", def.z_max));
+  }
+
+  //___________________________________________________________________________________________________
+  void FiducialVolume::PrintConfig() const
+  {
+    std::cout << "[FiducialVolume] x: " << _bounds.x_min << " to " << _bounds.x_max
+              << ", y: " << _bounds.y_min << " to " << _bounds.y_max
+              << ", z: " << _bounds.z_min << " to " << _bounds.z_max
+              << (_is_default ? " (default)" : "") << std::endl;
+  }
+
+  //___________________________________________________________________________________________________
+  template <class Box>
+  void FiducialVolume::InFV(Box const& b, size_t n, double const* x, double const* y, double const* z, unsigned char* inside)
+  {
+    for (size_t i = 0; i < n; i++) {
+      inside[i] = Contains(b, x[i], y[i], z[i]);
+    }
+  }
+
+  //___________________________________________________________________________________________________
+  template <class Box>
+  void FiducialVolume::ClassifyTracks(Box const& b, size_t n,
+                                      double const* sx, double const* sy, double const* sz,
+                                      double const* ex, double const* ey, double const* ez,
+                                      unsigned char* flags)
+  {
+    for (size_t i = 0; i < n; i++) {
+      flags[i] = Classify(b, sx[i], sy[i], sz[i], ex[i], ey[i], ez[i]);
+    }
+  }
+
+  //___________________________________________________________________________________________________
+  void FiducialVolume::InFV(size_t n, double const* x, double const* y, double const* z, unsigned char* inside) const
+  {
+    if (_is_default) InFV(MicroBooNEFVBox(), n, x, y, z, inside);
+    else             InFV(_bounds, n, x, y, z, inside);
+  }
+
+  //___________________________________________________________________________________________________
+  void FiducialVolume::ClassifyTracks(size_t n,
+                                      double const* sx, double const* sy, double const* sz,
+                                      double const* ex, double const* ey, double const* ez,
+                                      unsigned char* flags) const
+  {
+    if (_is_default) ClassifyTracks(MicroBooNEFVBox(), n, sx, sy, sz, ex, ey, ez, flags);
+    else             ClassifyTracks(_bounds, n, sx, sy, sz, ex, ey, ez, flags);
+  }
+
+  //___________________________________________________________________________________________________
+  unsigned char FiducialVolume::ClassifyTrack(double const* start, double const* end) const
+  {
+    return Classify(_bounds, start[0], start[1], start[2], end[0], end[1], end[2]);
+  }
+}
+
+#endif
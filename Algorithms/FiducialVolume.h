@@ -0,0 +1,160 @@
+/**
+ * \file FiducialVolume.h
+ *
+ * \ingroup UBXSec
+ *
+ * \brief Fiducial volume box, with point and track containment checks
+ *
+ * @author Marco Del Tutto
+ */
+
+/** \addtogroup UBXSec
+
+    @{*/
+
+#ifndef FIDUCIALVOLUME_H
+#define FIDUCIALVOLUME_H
+
+#include <iostream>
+#include <vector>
+#include "fhiclcpp/ParameterSet.h"
+
+namespace ubxsec {
+
+  /// Default MicroBooNE fiducial volume: 10 cm from the TPC in x and z, 20 cm in y
+  struct MicroBooNEFVBox {
+    static constexpr double x_min = 10.;
+    static constexpr double x_max = 256.35 - 10.;
+    static constexpr double y_min = -233/2. + 20.;
+    static constexpr double y_max = 233/2. - 20.;
+    static constexpr double z_min = 10.;
+    static constexpr double z_max = 1036.8 - 10.;
+  };
+
+  /// Fiducial volume box set at run time
+  struct FVBounds {
+    double x_min = MicroBooNEFVBox::x_min;
+    double x_max = MicroBooNEFVBox::x_max;
+    double y_min = MicroBooNEFVBox::y_min;
+    double y_max = MicroBooNEFVBox::y_max;
+    double z_min = MicroBooNEFVBox::z_min;
+    double z_max = MicroBooNEFVBox::z_max;
+  };
+
+  /**
+   * All the checks are written without branches (bitwise and of the
+   * comparisons), so that the batch versions vectorise. When the box is the
+   * default one, the batch versions run on the compile-time MicroBooNEFVBox.
+   */
+  class FiducialVolume {
+
+  public:
+
+    /// Bits of the track classification
+    enum TrackFlag : unsigned char {
+      kStartInFV   = 1 << 0, ///< The track start is in the FV
+      kEndInFV     = 1 << 1, ///< The track end is in the FV
+      kCrossing    = 1 << 2, ///< Only one of start and end is in the FV
+      kCrossingTop = 1 << 3, ///< Crossing, and the point outside is above the FV
+    };
+
+    /// Default constructor, default MicroBooNE box
+    FiducialVolume() = default;
+
+    /// Constructor from the box edges
+    FiducialVolume(double x_min, double x_max, double y_min, double y_max, double z_min, double z_max);
+
+    /// Configure function parameters, missing edges are taken from the default box
+    void Configure(fhicl::ParameterSet const& p);
+
+    /// Prints the box edges
+    void PrintConfig() const;
+
+    /// Returns the box edges
+    const FVBounds & Bounds() const { return _bounds; }
+
+    /// Returns true if the box is the default MicroBooNE box
+    bool IsDefault() const { return _is_default; }
+
+    /// Returns true if the point is in the FV
+    bool InFV(double x, double y, double z) const { return Contains(_bounds, x, y, z); }
+
+    /// Returns true if the point (c array) is in the FV
+    bool InFV(double const* xyz) const { return Contains(_bounds, xyz[0], xyz[1], xyz[2]); }
+
+    /// Returns true if the point (c array) is in the default MicroBooNE FV
+    static bool InDefaultFV(double const* xyz) { return Contains(MicroBooNEFVBox(), xyz[0], xyz[1], xyz[2]); }
+
+    /**
+     *  @brief Batch version of InFV
+     *
+     *  @param n the number of points
+     *  @param x the x coordinates of the points
+     *  @param y the y coordinates of the points
+     *  @param z the z coordinates of the points
+     *  @param inside output, 1 if the point is in the FV, 0 otherwise (n entries)
+     */
+    void InFV(size_t n, double const* x, double const* y, double const* z, unsigned char* inside) const;
+
+    /**
+     *  @brief Classifies tracks from their start and end points, see TrackFlag
+     *
+     *  @param n the number of tracks
+     *  @param sx the x coordinates of the start points (sy, sz for y and z)
+     *  @param ex the x coordinates of the end points (ey, ez for y and z)
+     *  @param flags output, the TrackFlag bits of each track (n entries)
+     */
+    void ClassifyTracks(size_t n,
+                        double const* sx, double const* sy, double const* sz,
+                        double const* ex, double const* ey, double const* ez,
+                        unsigned char* flags) const;
+
+    /// Classifies a single track, see TrackFlag
+    unsigned char ClassifyTrack(double const* start, double const* end) const;
+
+    /// Returns 0 if the track is crossing with the start in the FV, 1 if with the end in the FV, -1 if not crossing
+    static int VertexOk(unsigned char flags)
+    {
+      if (!(flags & kCrossing)) return -1;
+      return (flags & kStartInFV) ? 0 : 1;
+    }
+
+  private:
+
+    template <class Box>
+    static bool Contains(Box const& b, double x, double y, double z)
+    {
+      return (x > b.x_min) & (x < b.x_max) &
+             (y > b.y_min) & (y < b.y_max) &
+             (z > b.z_min) & (z < b.z_max);
+    }
+
+    template <class Box>
+    static unsigned char Classify(Box const& b,
+                                  double sx, double sy, double sz,
+                                  double ex, double ey, double ez)
+    {
+      unsigned char s_in = Contains(b, sx, sy, sz);
+      unsigned char e_in = Contains(b, ex, ey, ez);
+      unsigned char crossing = s_in ^ e_in;
+      double out_y = s_in ? ey : sy;
+      unsigned char top = crossing & (out_y > b.y_max);
+      return s_in | (e_in << 1) | (crossing << 2) | (top << 3);
+    }
+
+    template <class Box>
+    static void InFV(Box const& b, size_t n, double const* x, double const* y, double const* z, unsigned char* inside);
+
+    template <class Box>
+    static void ClassifyTracks(Box const& b, size_t n,
+                               double const* sx, double const* sy, double const* sz,
+                               double const* ex, double const* ey, double const* ez,
+                               unsigned char* flags);
+
+    FVBounds _bounds;          ///< Box edges
+    bool _is_default = true;   ///< True if _bounds is the default MicroBooNE box
+  };
+}
+
+#endif
+/** @} */ // end of doxygen group
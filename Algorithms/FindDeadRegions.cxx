@@ -33,94 +33,146 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <cmath>
+#include <random>
+#include <thread>
+
+#include "cetlib/search_path.h"
 
 #include "FindDeadRegions.h"
+#include "DeadRegionsSnapshot.h"
 
 FindDeadRegions::FindDeadRegions()//fhicl::ParameterSet const & p, art::ActivityRegistry & areg)
 // :
 // Initialize member data here.
 {
 
-  // Load boundary wires at initialization
-  LoadBWires();
+  // Boundary wires are loaded at the first query, after Configure
 
 }
 
 void FindDeadRegions::Configure(fhicl::ParameterSet const& pset) {
   _use_file   = pset.get< bool   > ( "UseFile",   false );
+  _geo_file   = pset.get< std::string > ( "GeometryFile",      "ChannelWireGeometry_v2.txt" );
+  _status_file = pset.get< std::string > ( "ChannelStatusFile", "ChanStatus.txt" );
+  _snapshot_file = pset.get< std::string > ( "SnapshotFile",    "" );
   _tolerance  = pset.get< double > ( "Tolerance", 0.6   ); //cm
   _ch_thres   = pset.get< int >    ( "ChThres",   4     ); 
+
+  _use_dist_map      = pset.get< bool   > ( "UseDistanceMap",        false );
+  _dist_map_res      = pset.get< double > ( "DistanceMapResolution", 0.5   ); //cm
+  _validate_dist_map = pset.get< bool   > ( "ValidateDistanceMap",   false );
+
+  _n_threads         = pset.get< int    > ( "NThreads",              0     ); // 0: one per core
+
+  _dist_map_ready[0] = _dist_map_ready[1] = _dist_map_ready[2] = false;
+
+  // Everything is (re)loaded lazily with the new configuration
+  _geometry_loaded = false;
+  _bwires_loaded = false;
+  _ch_status.clear();
 }
 
 
 void FindDeadRegions::LoadBWires() {
 
-  std::cout << "[FindDeadRegions] Loading wires from " << (_use_file ? " files." : "database.") << std::endl;
+  std::cout << "[FindDeadRegions] Loading wires from "
+            << (!_snapshot_file.empty() ? "snapshot." : (_use_file ? "files." : "database.")) << std::endl;
+
+  LoadGeometry();
+
+  // Forget the previous statuses so that all the planes are rebuilt
+  _ch_status.clear();
+
+  UpdateChannelStatus();
+
+  // Do not try again at every query if something went wrong
+  _bwires_loaded = true;
+
+  std::cout << "[FindDeadRegions] LoadBwires ends." << std::endl;
+
+  return;
+}
+
+
+//___________________________________________________________________________________________________
+std::string FindDeadRegions::SnapshotPath() const {
+
+  // Look for the snapshot in FW_SEARCH_PATH first, then use the name as it is
+  std::string full_path;
+  cet::search_path sp("FW_SEARCH_PATH");
+  if (sp.find_file(_snapshot_file, full_path))
+    return full_path;
+
+  return _snapshot_file;
+}
+
+
+//___________________________________________________________________________________________________
+void FindDeadRegions::LoadGeometry() {
+
+  std::cout << "[FindDeadRegions] Loading geometry." << std::endl;
 
-  ::art::ServiceHandle<geo::Geometry> geo;
+  _ch_wire.clear();
+  _ch_sy.clear();
+  _ch_sz.clear();
+  _ch_ey.clear();
+  _ch_ez.clear();
 
-  unsigned int channel;
-  unsigned int plane;
   unsigned int wire;
-  float sx;
   float sy;
   float sz;
-  float ex;
   float ey;
   float ez;
 
-  std::vector<unsigned int> channelVec;
-  std::vector<unsigned int> planeVec;
-  std::vector<unsigned int> wireVec;
-  std::vector<float> sxVec;
-  std::vector<float> syVec;
-  std::vector<float> szVec;
-  std::vector<float> exVec;
-  std::vector<float> eyVec;
-  std::vector<float> ezVec;
+  if (!_snapshot_file.empty()) {
+
+    // **********
+    // From Snapshot
+    // **********
 
-  double xyz[3];
+    ubxsec::DeadRegionsSnapshot snapshot;
+    if (!snapshot.Open(SnapshotPath())) return;
 
-  std::cout << "[FindDeadRegions] Loading geometry." << std::endl;
+    unsigned int n = snapshot.NChannels();
+    _ch_wire.assign(snapshot.Wire(),   snapshot.Wire()   + n);
+    _ch_sy.assign  (snapshot.StartY(), snapshot.StartY() + n);
+    _ch_sz.assign  (snapshot.StartZ(), snapshot.StartZ() + n);
+    _ch_ey.assign  (snapshot.EndY(),   snapshot.EndY()   + n);
+    _ch_ez.assign  (snapshot.EndZ(),   snapshot.EndZ()   + n);
 
-  if (!_use_file) {
+  } else if (!_use_file) {
 
     // **********
     // From Geometry
     // **********
 
+    ::art::ServiceHandle<geo::Geometry> geo;
+
+    double xyz[3];
+
     // Loop over all the channels
     for (unsigned int ch = 0; ch < 8256; ch++) {
 
-      channel = ch;
-
-      std::vector< geo::WireID > wire_v = geo->ChannelToWire(channel);
+      std::vector< geo::WireID > wire_v = geo->ChannelToWire(ch);
 
       wire  = wire_v[0].Wire;
-      plane = wire_v[0].Plane;
 
       geo::WireGeo wire_g = geo->Wire (wire_v[0]);
 
       wire_g.GetStart (xyz);
-      sx = xyz[0];
       sy = xyz[1];
       sz = xyz[2];
 
       wire_g.GetEnd (xyz);
-      ex = xyz[0];
       ey = xyz[1];
       ez = xyz[2];
 
-
-      channelVec.push_back(channel);
-      planeVec.push_back(plane);
-      wireVec.push_back(wire);
-      sxVec.push_back(sx);
-      syVec.push_back(sy);
-      szVec.push_back(sz);
-      exVec.push_back(ex);
-      eyVec.push_back(ey);
-      ezVec.push_back(ez); 
+      _ch_wire.push_back(wire);
+      _ch_sy.push_back(sy);
+      _ch_sz.push_back(sz);
+      _ch_ey.push_back(ey);
+      _ch_ez.push_back(ez);
 
     } // channel loop
   } else {
@@ -129,75 +181,52 @@ void FindDeadRegions::LoadBWires() {
     // From File
     // **********
 
-    std::ifstream geofile;
-    geofile.open("ChannelWireGeometry_v2.txt");
-     if (!geofile.is_open())
-      std::cerr << "Problem opening file ChannelWireGeometry_v2.txt."  << std::endl;
-
-    std::string string_channel;
-    std::string string_plane;
-    std::string string_wire;
-    std::string string_sx;
-    std::string string_sy;
-    std::string string_sz;
-    std::string string_ex;
-    std::string string_ey;
-    std::string string_ez;
-
-    std::string dummy;
-
-    getline(geofile,dummy);
-    getline(geofile,dummy);
-    getline(geofile,dummy);
-    getline(geofile,dummy);
-    getline(geofile,dummy);
-    getline(geofile,dummy);
-    getline(geofile,dummy);
-    getline(geofile,dummy);
-    getline(geofile,dummy);
-
-    while(geofile >> string_channel)
-    {
-      geofile >> string_plane;
-      geofile >> string_wire;
-      geofile >> string_sx;
-      geofile >> string_sy;
-      geofile >> string_sz;
-      geofile >> string_ex;
-      geofile >> string_ey;
-      geofile >> string_ez;
-
-      channel = atoi(string_channel.c_str());
-      plane = atoi(string_plane.c_str());
-      wire = atoi(string_wire.c_str());
-      sx = atof(string_sx.c_str());
-      sy = atof(string_sy.c_str());
-      sz = atof(string_sz.c_str());
-      ex = atof(string_ex.c_str());
-      ey = atof(string_ey.c_str());
-      ez = atof(string_ez.c_str());
-
-      channelVec.push_back(channel);
-      planeVec.push_back(plane);
-      wireVec.push_back(wire);
-      sxVec.push_back(sx);
-      syVec.push_back(sy);
-      szVec.push_back(sz);
-      exVec.push_back(ex);
-      eyVec.push_back(ey);
-      ezVec.push_back(ez);
-    }
-
-    geofile.close();
+    if (!ubxsec::DeadRegionsSnapshot::ReadGeometryText(_geo_file, _ch_wire, _ch_sy, _ch_sz, _ch_ey, _ch_ez))
+      return;
   }
 
+  _wire_projector.Configure(_ch_wire, _ch_sy, _ch_sz, _ch_ey, _ch_ez, _plane_first_ch);
 
-  std::vector<unsigned int> CSchannelVec;
-  std::vector<bool> CSstatusVec;
+  _geometry_loaded = true;
+}
 
-  std::cout << "[FindDeadRegions] Loading channel statuses." << std::endl;
 
-  if (!_use_file) {
+//___________________________________________________________________________________________________
+const ubxsec::WireProjector & FindDeadRegions::GetWireProjector() {
+
+  // Loads the geometry, once even if it failed
+  if (!_bwires_loaded) LoadBWires();
+
+  return _wire_projector;
+}
+
+
+//___________________________________________________________________________________________________
+void FindDeadRegions::Prepare() {
+
+  if (!_bwires_loaded) LoadBWires();
+
+  if (_use_dist_map && !DistanceMapReady()) BuildDistanceMap();
+}
+
+
+//___________________________________________________________________________________________________
+void FindDeadRegions::LoadChannelStatus(std::vector<bool> & status) {
+
+  status.clear();
+
+  if (!_snapshot_file.empty()) {
+
+    // **********
+    // From Snapshot
+    // **********
+
+    ubxsec::DeadRegionsSnapshot snapshot;
+    if (!snapshot.Open(SnapshotPath())) return;
+
+    status.assign(snapshot.Status(), snapshot.Status() + snapshot.NChannels());
+
+  } else if (!_use_file) {
 
     // **********
     // From Database
@@ -207,13 +236,11 @@ void FindDeadRegions::LoadBWires() {
 
     for (unsigned int channel = 0; channel < 8256; channel++) {
 
-      CSchannelVec.push_back(channel);
-
       // Channel statuses: 1=dead, 3=noisy, 4=good
       if (chanFilt.Status(channel) < _ch_thres) {
-        CSstatusVec.push_back(false);
+        status.push_back(false);
       } else {
-        CSstatusVec.push_back(true);
+        status.push_back(true);
       }
     }
   } else {
@@ -222,231 +249,532 @@ void FindDeadRegions::LoadBWires() {
     // From File
     // **********
 
-    std::ifstream chanstatfile;
-    chanstatfile.open("ChanStatus.txt");
-    if (!chanstatfile.is_open())
-      std::cerr << "Problem opening file ChanStatus.txt."  << std::endl;
+    ubxsec::DeadRegionsSnapshot::ReadStatusText(_status_file, status);
+  }
+}
 
-    std::string string_CSchannel;
-    std::string string_CSstatus;
 
-    unsigned int CSchannel;
-    bool CSstatus;
+//___________________________________________________________________________________________________
+bool FindDeadRegions::UpdateChannelStatus() {
 
-    while(chanstatfile >> string_CSchannel)
-    {
-      chanstatfile >> string_CSstatus;
+  if (!_geometry_loaded) LoadGeometry();
 
-      CSchannel = atoi(string_CSchannel.c_str());
-      CSstatus = atoi(string_CSstatus.c_str());
+  std::cout << "[FindDeadRegions] Loading channel statuses." << std::endl;
 
-      CSchannelVec.push_back(CSchannel);
-      CSstatusVec.push_back(CSstatus);
-    }
+  std::vector<bool> status;
+  LoadChannelStatus(status);
 
-    chanstatfile.close();
+  if (status.size() != 8256 || _ch_wire.size() != 8256) {
+    std::cerr << "[FindDeadRegions] Expected 8256 channels, got " << _ch_wire.size()
+              << " from the geometry and " << status.size() << " statuses." << std::endl;
+    return false;
   }
 
-  std::cout << "[FindDeadRegions] Loading ended." << std::endl;
+  bool changed = false;
 
-  bool isGoodChannel;
+  for (int plane = 0; plane < 3; plane++) {
 
-  isGoodChannel = true;
-  for(int i = 0; i < 2400; i++) {
-    if((CSstatusVec.at(i) == false) && (isGoodChannel == true)) {
-      isGoodChannel = false;
+    // Only rebuild the planes where at least one channel changed status
+    if (_ch_status.size() == status.size() &&
+        std::equal(status.begin() + _plane_first_ch[plane],
+                   status.begin() + _plane_first_ch[plane+1],
+                   _ch_status.begin() + _plane_first_ch[plane]))
+      continue;
 
-      BoundaryWire BWire;
-      BWire.wire_num = wireVec.at(i);
-      BWire.y_start = syVec.at(i);
-      BWire.z_start = szVec.at(i);
-      BWire.y_end = eyVec.at(i);
-      BWire.z_end = ezVec.at(i);
-      BWire.isLowWire = true;
+    std::cout << "[FindDeadRegions] Building boundary wires for plane " << plane << "." << std::endl;
 
-      BWires_U.push_back(BWire);
-    }
-    else if((CSstatusVec.at(i) == true) && (isGoodChannel == false)) {
-      isGoodChannel = true;
+    BuildBWires(plane, status);
+    BuildBoundaryIndex(plane);
+    BuildBadChannelCount(plane, status);
+    _dist_map_ready[plane] = false;
 
-      BoundaryWire BWire;
-      BWire.wire_num = wireVec.at(i-1);
-      BWire.y_start = syVec.at(i-1);
-      BWire.z_start = szVec.at(i-1);
-      BWire.y_end = eyVec.at(i-1);
-      BWire.z_end = ezVec.at(i-1);
-      BWire.isLowWire = false;
+    changed = true;
+  }
 
-      BWires_U.push_back(BWire);
-    }
-    else if((i == 2399) && (CSstatusVec.at(i) == false) && (isGoodChannel == false)) {
-      BoundaryWire BWire;
-      BWire.wire_num = wireVec.at(i);
-      BWire.y_start = syVec.at(i);
-      BWire.z_start = szVec.at(i);
-      BWire.y_end = eyVec.at(i);
-      BWire.z_end = ezVec.at(i);
-      BWire.isLowWire = false;
+  _ch_status = status;
+  _bwires_loaded = true;
 
-      BWires_U.push_back(BWire);
+  return changed;
+}
 
-    }
+
+//___________________________________________________________________________________________________
+void FindDeadRegions::BuildBadChannelCount(int plane, std::vector<bool> const& status) {
+
+  // Plane p uses the entries [_plane_first_ch[p] + p, _plane_first_ch[p+1] + p]
+  _ch_bad_count.resize(_plane_first_ch[3] + 3, 0);
+
+  unsigned int offset = _plane_first_ch[plane] + plane;
+  unsigned int n_bad = 0;
+
+  for (int ch = _plane_first_ch[plane]; ch < _plane_first_ch[plane+1]; ch++) {
+    _ch_bad_count[offset + ch - _plane_first_ch[plane]] = n_bad;
+    if (!status[ch]) n_bad++;
   }
+  _ch_bad_count[offset + _plane_first_ch[plane+1] - _plane_first_ch[plane]] = n_bad;
+}
 
-  isGoodChannel = true;
-  for(int i = 2400; i < 4800; i++) {
-    if((CSstatusVec.at(i) == false) && (isGoodChannel == true)) {
-      isGoodChannel = false;
 
-      BoundaryWire BWire;
-      BWire.wire_num = wireVec.at(i);
-      BWire.y_start = syVec.at(i);
-      BWire.z_start = szVec.at(i);
-      BWire.y_end = eyVec.at(i);
-      BWire.z_end = ezVec.at(i);
-      BWire.isLowWire = true;
+//___________________________________________________________________________________________________
+bool FindDeadRegions::ChannelNearBadChannel(unsigned int ch, int window) {
 
-      BWires_V.push_back(BWire);
-    }
-    else if((CSstatusVec.at(i) == true) && (isGoodChannel == false)) {
-      isGoodChannel = true;
+  if (!_bwires_loaded) LoadBWires();
 
-      BoundaryWire BWire;
-      BWire.wire_num = wireVec.at(i-1);
-      BWire.y_start = syVec.at(i-1);
-      BWire.z_start = szVec.at(i-1);
-      BWire.y_end = eyVec.at(i-1);
-      BWire.z_end = ezVec.at(i-1);
-      BWire.isLowWire = false;
+  if (_ch_bad_count.size() != (size_t)(_plane_first_ch[3] + 3)) return false;
+  if (ch >= (unsigned int)_plane_first_ch[3]) return false;
 
-      BWires_V.push_back(BWire);
-    }
-    else if((i == 4799) && (CSstatusVec.at(i) == false) && (isGoodChannel == false)) {
-      BoundaryWire BWire;
-      BWire.wire_num = wireVec.at(i);
-      BWire.y_start = syVec.at(i);
-      BWire.z_start = szVec.at(i);
-      BWire.y_end = eyVec.at(i);
-      BWire.z_end = ezVec.at(i);
-      BWire.isLowWire = false;
+  int plane = 0;
+  while ((int)ch >= _plane_first_ch[plane+1]) plane++;
 
-      BWires_V.push_back(BWire);
-    }
-  }
+  // Window clamped to the plane edges
+  int first = std::max((int)ch - window, _plane_first_ch[plane]);
+  int last  = std::min((int)ch + window, _plane_first_ch[plane+1] - 1);
+
+  return _ch_bad_count[last + 1 + plane] > _ch_bad_count[first + plane];
+}
+
+
+//___________________________________________________________________________________________________
+void FindDeadRegions::BuildBWires(int plane, std::vector<bool> const& status) {
+
+  std::vector<BoundaryWire> & bwires = (plane == 0 ? BWires_U : (plane == 1 ? BWires_V : BWires_Y));
+
+  bwires.clear();
 
-  isGoodChannel = true;
-  for(int i = 4800; i < 8256; i++) {
-    if((CSstatusVec.at(i) == false) && (isGoodChannel == true)) {
+  int first_ch = _plane_first_ch[plane];
+  int last_ch  = _plane_first_ch[plane+1] - 1;
+
+  bool isGoodChannel = true;
+
+  for(int i = first_ch; i <= last_ch; i++) {
+    if((status.at(i) == false) && (isGoodChannel == true)) {
       isGoodChannel = false;
 
       BoundaryWire BWire;
-      BWire.wire_num = wireVec.at(i);
-      BWire.y_start = syVec.at(i);
-      BWire.z_start = szVec.at(i);
-      BWire.y_end = eyVec.at(i);
-      BWire.z_end = ezVec.at(i);
+      BWire.wire_num = _ch_wire.at(i);
+      BWire.y_start = _ch_sy.at(i);
+      BWire.z_start = _ch_sz.at(i);
+      BWire.y_end = _ch_ey.at(i);
+      BWire.z_end = _ch_ez.at(i);
       BWire.isLowWire = true;
 
-      BWires_Y.push_back(BWire);
+      bwires.push_back(BWire);
     }
-    else if((CSstatusVec.at(i) == true) && (isGoodChannel == false)) {
+    else if((status.at(i) == true) && (isGoodChannel == false)) {
       isGoodChannel = true;
 
       BoundaryWire BWire;
-      BWire.wire_num = wireVec.at(i-1);
-      BWire.y_start = syVec.at(i-1);
-      BWire.z_start = szVec.at(i-1);
-      BWire.y_end = eyVec.at(i-1);
-      BWire.z_end = ezVec.at(i-1);
+      BWire.wire_num = _ch_wire.at(i-1);
+      BWire.y_start = _ch_sy.at(i-1);
+      BWire.z_start = _ch_sz.at(i-1);
+      BWire.y_end = _ch_ey.at(i-1);
+      BWire.z_end = _ch_ez.at(i-1);
       BWire.isLowWire = false;
 
-      BWires_Y.push_back(BWire);
+      bwires.push_back(BWire);
     }
-    else if((i == 8255) && (CSstatusVec.at(i) == false) && (isGoodChannel == false)) {
+    else if((i == last_ch) && (status.at(i) == false) && (isGoodChannel == false)) {
       BoundaryWire BWire;
-      BWire.wire_num = wireVec.at(i);
-      BWire.y_start = syVec.at(i);
-      BWire.z_start = szVec.at(i);
-      BWire.y_end = eyVec.at(i);
-      BWire.z_end = ezVec.at(i);
+      BWire.wire_num = _ch_wire.at(i);
+      BWire.y_start = _ch_sy.at(i);
+      BWire.z_start = _ch_sz.at(i);
+      BWire.y_end = _ch_ey.at(i);
+      BWire.z_end = _ch_ez.at(i);
       BWire.isLowWire = false;
 
-      BWires_Y.push_back(BWire);
+      bwires.push_back(BWire);
     }
   }
-
-  std::cout << "[FindDeadRegions] LoadBwires ends." << std::endl;
-
-  return;
 }
 
 
 //___________________________________________________________________________________________________
-bool FindDeadRegions::NearDeadReg2P(float yVal, float zVal, float tolerance) {
+float FindDeadRegions::ScanPlane(int plane, float yVal, float zVal, bool & inside) const {
 
-  float minDist_U = 100000.0;
-  float minDist_V = 100000.0;
-  float minDist_Y = 100000.0;
+  const std::vector<BoundaryWire> & bwires = (plane == 0 ? BWires_U : (plane == 1 ? BWires_V : BWires_Y));
 
-  for (unsigned int i = 0; i < BWires_U.size(); i++) {
-    float m = (BWires_U[i].y_end-BWires_U[i].y_start)/(BWires_U[i].z_end-BWires_U[i].z_start);
-    float b = BWires_U[i].y_start - m*BWires_U[i].z_start;
-    float dist = fabs(yVal-m*zVal-b)/sqrt(pow(m,2)+1.0);
+  float minDist = 100000.0;
+  inside = false;
 
-    if (dist < minDist_U) {
-      minDist_U = dist;
-    }
+  if (plane == 2) {
 
-    if (BWires_U[i].isLowWire == true) {
-      float m_next = (BWires_U[i+1].y_end-BWires_U[i+1].y_start)/(BWires_U[i+1].z_end-BWires_U[i+1].z_start);
-      float b_next = BWires_U[i+1].y_start - m*BWires_U[i+1].z_start;
-      float y1 = m*zVal + b;
-      float y2 = m_next*zVal + b_next;
+    for (unsigned int i = 0; i < bwires.size(); i++) {
+      float dist = fabs(zVal-bwires[i].z_start);
+
+      if (dist < minDist) {
+        minDist = dist;
+      }
 
-      if ((yVal <= y1) && (yVal >= y2)) {
-        minDist_U = 0.0;
+      if (bwires[i].isLowWire == true) {
+        float z1 = bwires[i].z_start;
+        float z2 = bwires[i+1].z_start;
+
+        if ((zVal >= z1) && (zVal <= z2)) {
+          inside = true;
+        }
       }
     }
+
+    return minDist;
   }
 
-  for (unsigned int i = 0; i < BWires_V.size(); i++) {
-    float m = (BWires_V[i].y_end-BWires_V[i].y_start)/(BWires_V[i].z_end-BWires_V[i].z_start);
-    float b = BWires_V[i].y_start - m*BWires_V[i].z_start;
+  for (unsigned int i = 0; i < bwires.size(); i++) {
+    float m = (bwires[i].y_end-bwires[i].y_start)/(bwires[i].z_end-bwires[i].z_start);
+    float b = bwires[i].y_start - m*bwires[i].z_start;
     float dist = fabs(yVal-m*zVal-b)/sqrt(pow(m,2)+1.0);
 
-    if (dist < minDist_V) {
-      minDist_V = dist;
+    if (dist < minDist) {
+      minDist = dist;
     }
- 
-    if (BWires_V[i].isLowWire == true) {
-      float m_next = (BWires_V[i+1].y_end-BWires_V[i+1].y_start)/(BWires_V[i+1].z_end-BWires_V[i+1].z_start);
-      float b_next = BWires_V[i+1].y_start - m*BWires_V[i+1].z_start;
+
+    if (bwires[i].isLowWire == true) {
+      float m_next = (bwires[i+1].y_end-bwires[i+1].y_start)/(bwires[i+1].z_end-bwires[i+1].z_start);
+      float b_next = bwires[i+1].y_start - m*bwires[i+1].z_start;
       float y1 = m*zVal + b;
       float y2 = m_next*zVal + b_next;
 
-      if ((yVal >= y1) && (yVal <= y2)) {
-        minDist_V = 0.0;
+      // U wires go down in y with increasing wire number, V wires go up
+      if (plane == 0 && (yVal <= y1) && (yVal >= y2)) {
+        inside = true;
+      }
+      if (plane == 1 && (yVal >= y1) && (yVal <= y2)) {
+        inside = true;
       }
     }
   }
 
-  for (unsigned int i = 0; i < BWires_Y.size(); i++) {
-    float dist = fabs(zVal-BWires_Y[i].z_start);
+  return minDist;
+}
+
+
 
-    if (dist < minDist_Y) {
-      minDist_Y = dist;
+//___________________________________________________________________________________________________
+void FindDeadRegions::BuildBoundaryIndex(int plane) {
+
+  const std::vector<BoundaryWire> & bwires = (plane == 0 ? BWires_U : (plane == 1 ? BWires_V : BWires_Y));
+  BoundaryIndex & index = _bwires_index[plane];
+
+  index = BoundaryIndex();
+
+  if (bwires.empty()) return;
+
+  // All the wires on a plane are parallel, take the direction from
+  // the longest one, as the end points of short wires are less precise
+  float dy = 0., dz = 0., length = 0.;
+  for (auto const& bwire : bwires) {
+    float l = sqrt(pow(bwire.y_end - bwire.y_start, 2) + pow(bwire.z_end - bwire.z_start, 2));
+    if (l > length) {
+      dy = bwire.y_end - bwire.y_start;
+      dz = bwire.z_end - bwire.z_start;
+      length = l;
     }
+  }
+  if (length > 0.) {
+    index.dir_y = (dy >= 0. ? 1. : -1.) * dy / length;
+    index.dir_z = (dy >= 0. ? 1. : -1.) * dz / length;
+  }
+
+  // Line coefficients, computed as in ScanPlane so that distances are identical
+  if (plane != 2) {
+    for (auto const& bwire : bwires) {
+      float m = (bwire.y_end-bwire.y_start)/(bwire.z_end-bwire.z_start);
+      float b = bwire.y_start - m*bwire.z_start;
+      index.m.push_back(m);
+      index.b.push_back(b);
+      index.norm.push_back(sqrt(pow(m,2)+1.0));
+    }
+  }
+
+  std::vector<std::pair<float, unsigned int>> coord_v;
+  std::vector<std::pair<float, unsigned int>> band_v;
+
+  for (unsigned int i = 0; i < bwires.size(); i++) {
+    float c = index.dir_y * bwires[i].z_start - index.dir_z * bwires[i].y_start;
+    coord_v.emplace_back(c, i);
+
+    if (bwires[i].isLowWire && i + 1 < bwires.size()) {
+      float c_next = index.dir_y * bwires[i+1].z_start - index.dir_z * bwires[i+1].y_start;
+      band_v.emplace_back(std::min(c, c_next), i);
+    }
+  }
+
+  std::sort(coord_v.begin(), coord_v.end());
+  std::sort(band_v.begin(), band_v.end());
+
+  for (auto const& c : coord_v) {
+    index.coord.push_back(c.first);
+    index.coord_wire.push_back(c.second);
+  }
+  for (auto const& c : band_v) {
+    unsigned int i = c.second;
+    float c_low  = index.dir_y * bwires[i].z_start   - index.dir_z * bwires[i].y_start;
+    float c_high = index.dir_y * bwires[i+1].z_start - index.dir_z * bwires[i+1].y_start;
+    index.band_start.push_back(c.first);
+    index.band_end.push_back(std::max(c_low, c_high));
+    index.band_wire.push_back(i);
+  }
+}
+
+
+
+//___________________________________________________________________________________________________
+bool FindDeadRegions::InBand(int plane, unsigned int i, float yVal, float zVal) const {
+
+  const std::vector<BoundaryWire> & bwires = (plane == 0 ? BWires_U : (plane == 1 ? BWires_V : BWires_Y));
+
+  if (plane == 2) {
+    float z1 = bwires[i].z_start;
+    float z2 = bwires[i+1].z_start;
+    return (zVal >= z1) && (zVal <= z2);
+  }
+
+  const BoundaryIndex & index = _bwires_index[plane];
+
+  float m = index.m[i];
+  float b = index.b[i];
+  float m_next = index.m[i+1];
+  float b_next = bwires[i+1].y_start - m*bwires[i+1].z_start;
+  float y1 = m*zVal + b;
+  float y2 = m_next*zVal + b_next;
+
+  if (plane == 0) return (yVal <= y1) && (yVal >= y2);
+  return (yVal >= y1) && (yVal <= y2);
+}
+
+
+
+//___________________________________________________________________________________________________
+float FindDeadRegions::SearchPlane(int plane, float yVal, float zVal, bool & inside) const {
+
+  const std::vector<BoundaryWire> & bwires = (plane == 0 ? BWires_U : (plane == 1 ? BWires_V : BWires_Y));
+  const BoundaryIndex & index = _bwires_index[plane];
+
+  float minDist = 100000.0;
+  inside = false;
+
+  if (bwires.empty()) return minDist;
+
+  float c = index.dir_y * zVal - index.dir_z * yVal;
+
+  // Closest boundary wires in the projected coordinate, plus neighbours
+  // to absorb the tiny differences in the single wire slopes
+  size_t k = std::lower_bound(index.coord.begin(), index.coord.end(), c) - index.coord.begin();
+  size_t first = (k > 2 ? k - 2 : 0);
+  size_t last  = std::min(k + 2, index.coord.size());
+
+  for (size_t j = first; j < last; j++) {
+    unsigned int i = index.coord_wire[j];
+    float dist;
+    if (plane == 2) dist = fabs(zVal-bwires[i].z_start);
+    else            dist = fabs(yVal-index.m[i]*zVal-index.b[i])/index.norm[i];
+
+    if (dist < minDist) {
+      minDist = dist;
+    }
+  }
+
+  // Dead band starting right before the point, plus neighbours
+  k = std::upper_bound(index.band_start.begin(), index.band_start.end(), c) - index.band_start.begin();
+  first = (k > 2 ? k - 2 : 0);
+  last  = std::min(k + 1, index.band_start.size());
+
+  for (size_t j = first; j < last; j++) {
+    if (InBand(plane, index.band_wire[j], yVal, zVal)) {
+      inside = true;
+      break;
+    }
+  }
+
+  return minDist;
+}
+
+
+
+//___________________________________________________________________________________________________
+void FindDeadRegions::GetMinDistances(float yVal, float zVal, float & minDist_U, float & minDist_V, float & minDist_Y) {
+
+  if (!_bwires_loaded) LoadBWires();
+
+  if (_use_dist_map) {
+
+    if (!DistanceMapReady()) BuildDistanceMap();
+
+    if (LookUpDistanceMap(yVal, zVal, minDist_U, minDist_V, minDist_Y))
+      return;
+  }
+
+  bool inside;
+
+  minDist_U = SearchPlane(0, yVal, zVal, inside);
+  if (inside) minDist_U = 0.0;
+
+  minDist_V = SearchPlane(1, yVal, zVal, inside);
+  if (inside) minDist_V = 0.0;
+
+  minDist_Y = SearchPlane(2, yVal, zVal, inside);
+  if (inside) minDist_Y = 0.0;
+}
+
+
+
+//___________________________________________________________________________________________________
+void FindDeadRegions::GetMinDistances(std::vector<float> const& yVal, std::vector<float> const& zVal, float tolerance,
+                                      std::vector<float> & minDist_U, std::vector<float> & minDist_V, std::vector<float> & minDist_Y,
+                                      std::vector<unsigned int> & plane_mask) {
+
+  if (!_bwires_loaded) LoadBWires();
+
+  size_t n_points = std::min(yVal.size(), zVal.size());
+
+  minDist_U.resize(n_points);
+  minDist_V.resize(n_points);
+  minDist_Y.resize(n_points);
+  plane_mask.resize(n_points);
+
+  bool inside;
+
+  for (size_t n = 0; n < n_points; n++) {
+
+    minDist_U[n] = SearchPlane(0, yVal[n], zVal[n], inside);
+    if (inside) minDist_U[n] = 0.0;
+
+    minDist_V[n] = SearchPlane(1, yVal[n], zVal[n], inside);
+    if (inside) minDist_V[n] = 0.0;
+
+    minDist_Y[n] = SearchPlane(2, yVal[n], zVal[n], inside);
+    if (inside) minDist_Y[n] = 0.0;
+
+    plane_mask[n] = (minDist_U[n] < tolerance ? 1 : 0)
+                  | (minDist_V[n] < tolerance ? 2 : 0)
+                  | (minDist_Y[n] < tolerance ? 4 : 0);
+  }
+}
+
+
+
+//___________________________________________________________________________________________________
+DeadRegionPathLength FindDeadRegions::GetDeadPathLength(recob::Track const& track, float tolerance) {
+
+  std::vector<TVector3> points;
+  points.reserve(track.NumberTrajectoryPoints());
+
+  for (size_t p = 0; p < track.NumberTrajectoryPoints(); p++)
+    points.push_back(track.LocationAtPoint(p));
+
+  return GetDeadPathLength(points, tolerance);
+}
+
+
+
+//___________________________________________________________________________________________________
+DeadRegionPathLength FindDeadRegions::GetDeadPathLength(std::vector<TVector3> const& points, float tolerance) {
+
+  if (!_bwires_loaded) LoadBWires();
+
+  DeadRegionPathLength result;
+
+  // Intervals of the segment parameter t in [0, 1] lying in a dead band, for each plane
+  std::vector<std::pair<double, double>> intervals[3];
+
+  // Sweep events to combine the planes: (t, +1 entering / -1 leaving)
+  std::vector<std::pair<double, int>> events;
+
+  for (size_t p = 1; p < points.size(); p++) {
+
+    double seg_length = (points[p] - points[p-1]).Mag();
+    if (seg_length <= 0.) continue;
+
+    result.length += seg_length;
+
+    events.clear();
 
-    if (BWires_Y[i].isLowWire == true) {
-      float z1 = BWires_Y[i].z_start;
-      float z2 = BWires_Y[i+1].z_start;
+    for (int plane = 0; plane < 3; plane++) {
 
-      if ((zVal >= z1) && (zVal <= z2)) {
-        minDist_Y = 0.0;
+      const BoundaryIndex & index = _bwires_index[plane];
+      intervals[plane].clear();
+
+      if (index.band_start.empty()) continue;
+
+      // The wire coordinate is linear along the segment
+      double c0 = index.dir_y * points[p-1].Z() - index.dir_z * points[p-1].Y();
+      double c1 = index.dir_y * points[p].Z()   - index.dir_z * points[p].Y();
+      double c_min = std::min(c0, c1);
+      double c_max = std::max(c0, c1);
+
+      // Bands are sorted and don't overlap: start from the last one
+      // beginning before the segment and stop after the segment end
+      size_t first = std::upper_bound(index.band_start.begin(), index.band_start.end(), c_min - tolerance) - index.band_start.begin();
+      first = (first > 0 ? first - 1 : 0);
+      size_t last = std::upper_bound(index.band_start.begin(), index.band_start.end(), c_max + tolerance) - index.band_start.begin();
+
+      for (size_t b = first; b < last; b++) {
+
+        double lo = index.band_start[b] - tolerance;
+        double hi = index.band_end[b]   + tolerance;
+
+        if (hi < c_min || lo > c_max) continue;
+
+        double t_a = 0.;
+        double t_b = 1.;
+
+        // A segment parallel to the wires is either fully in or out
+        if (c1 != c0) {
+          t_a = (lo - c0) / (c1 - c0);
+          t_b = (hi - c0) / (c1 - c0);
+          if (t_a > t_b) std::swap(t_a, t_b);
+          t_a = std::max(t_a, 0.);
+          t_b = std::min(t_b, 1.);
+        }
+
+        if (t_b <= t_a) continue;
+
+        intervals[plane].emplace_back(t_a, t_b);
+      }
+
+      // Bands widened by the tolerance can overlap, merge them
+      std::sort(intervals[plane].begin(), intervals[plane].end());
+      std::vector<std::pair<double, double>> merged;
+      for (auto const& interval : intervals[plane]) {
+        if (!merged.empty() && interval.first <= merged.back().second)
+          merged.back().second = std::max(merged.back().second, interval.second);
+        else
+          merged.push_back(interval);
       }
+
+      for (auto const& interval : merged) {
+        result.dead_length[plane] += (interval.second - interval.first) * seg_length;
+        events.emplace_back(interval.first, +1);
+        events.emplace_back(interval.second, -1);
+      }
+    }
+
+    if (events.empty()) continue;
+
+    // At equal t leaving events (-1) come first
+    std::sort(events.begin(), events.end());
+
+    int n_dead = 0;
+    double t_prev = 0.;
+    for (auto const& event : events) {
+      if (n_dead >= 1) result.dead_length_any += (event.first - t_prev) * seg_length;
+      if (n_dead >= 2) result.dead_length_2p  += (event.first - t_prev) * seg_length;
+      n_dead += event.second;
+      t_prev = event.first;
     }
   }
 
+  return result;
+}
+
+
+
+//___________________________________________________________________________________________________
+bool FindDeadRegions::NearDeadReg2P(float yVal, float zVal, float tolerance) {
+
+  float minDist_U, minDist_V, minDist_Y;
+
+  GetMinDistances(yVal, zVal, minDist_U, minDist_V, minDist_Y);
+
   if ((minDist_U < tolerance) && (minDist_V < tolerance)) {
     return true;
   }
@@ -467,89 +795,243 @@ bool FindDeadRegions::NearDeadReg2P(float yVal, float zVal, float tolerance) {
 //____________________________________________________________________________________________________
 bool FindDeadRegions::NearDeadReg3P(float yVal, float zVal, float tolerance) {
 
-  float minDist = 100000.0;
+  float minDist_U, minDist_V, minDist_Y;
 
-  for (unsigned int i = 0; i < BWires_U.size(); i++) {
-    float m = (BWires_U[i].y_end-BWires_U[i].y_start)/(BWires_U[i].z_end-BWires_U[i].z_start);
-    float b = BWires_U[i].y_start - m*BWires_U[i].z_start;
-    float dist = fabs(yVal-m*zVal-b)/sqrt(pow(m,2)+1.0);
+  GetMinDistances(yVal, zVal, minDist_U, minDist_V, minDist_Y);
 
-    if (dist < minDist) {
-      minDist = dist;
-    }
+  float minDist = std::min(minDist_U, std::min(minDist_V, minDist_Y));
 
-    if (BWires_U[i].isLowWire == true) {
-      float m_next = (BWires_U[i+1].y_end-BWires_U[i+1].y_start)/(BWires_U[i+1].z_end-BWires_U[i+1].z_start);
-      float b_next = BWires_U[i+1].y_start - m*BWires_U[i+1].z_start;
-      float y1 = m*zVal + b;
-      float y2 = m_next*zVal + b_next;
+  if (minDist < tolerance) {
+    return true;
+  }
+  else {
+    return false;
+  }
+}
+
+
+
+//____________________________________________________________________________________________________
+void FindDeadRegions::BuildDistanceMap() {
+
+  std::cout << "[FindDeadRegions] Building distance map with resolution " << _dist_map_res << " cm." << std::endl;
 
-      if ((yVal <= y1) && (yVal >= y2)) {
-        minDist = 0.0;
+  // The map covers the full wire planes, points outside are answered by the exact scan
+  float y_max = 117.5;
+  float z_max = 1038.;
+
+  _dist_map_ny = std::ceil((y_max - _dist_map_y_min) / _dist_map_res) + 1;
+  _dist_map_nz = std::ceil((z_max - _dist_map_z_min) / _dist_map_res) + 1;
+
+  bool inside;
+
+  for (int plane = 0; plane < 3; plane++) {
+
+    // Planes whose boundary wires did not change are kept
+    if (_dist_map_ready[plane] && _dist_map[plane].size() == (size_t)(_dist_map_ny * _dist_map_nz))
+      continue;
+
+    _dist_map[plane].resize(_dist_map_ny * _dist_map_nz);
+
+    for (int iz = 0; iz < _dist_map_nz; iz++) {
+      for (int iy = 0; iy < _dist_map_ny; iy++) {
+
+        float z = _dist_map_z_min + iz * _dist_map_res;
+        float y = _dist_map_y_min + iy * _dist_map_res;
+
+        float dist = SearchPlane(plane, y, z, inside);
+
+        // Store a signed distance so that the interpolation stays meaningful across the band edges
+        _dist_map[plane][iz * _dist_map_ny + iy] = (inside ? -dist : dist);
       }
     }
+
+    _dist_map_ready[plane] = true;
   }
 
-  for (unsigned int i = 0; i < BWires_V.size(); i++) {
-    float m = (BWires_V[i].y_end-BWires_V[i].y_start)/(BWires_V[i].z_end-BWires_V[i].z_start);
-    float b = BWires_V[i].y_start - m*BWires_V[i].z_start;
-    float dist = fabs(yVal-m*zVal-b)/sqrt(pow(m,2)+1.0);
+  std::cout << "[FindDeadRegions] Distance map built (" << _dist_map_nz << " x " << _dist_map_ny << " nodes per plane)." << std::endl;
 
-    if (dist < minDist) {
-      minDist = dist;
+  if (_validate_dist_map) ValidateDistanceMap();
+}
+
+
+
+//____________________________________________________________________________________________________
+bool FindDeadRegions::DistanceMapReady() const {
+
+  return _dist_map_ready[0] && _dist_map_ready[1] && _dist_map_ready[2];
+}
+
+
+
+//____________________________________________________________________________________________________
+bool FindDeadRegions::LookUpDistanceMap(float yVal, float zVal, float & minDist_U, float & minDist_V, float & minDist_Y) const {
+
+  float fz = (zVal - _dist_map_z_min) / _dist_map_res;
+  float fy = (yVal - _dist_map_y_min) / _dist_map_res;
+
+  if (!(fz >= 0. && fy >= 0.)) return false;
+
+  int iz = (int)fz;
+  int iy = (int)fy;
+
+  if (iz >= _dist_map_nz - 1 || iy >= _dist_map_ny - 1) return false;
+
+  float tz = fz - iz;
+  float ty = fy - iy;
+
+  float dist[3];
+
+  for (int plane = 0; plane < 3; plane++) {
+
+    const float * node = &_dist_map[plane][iz * _dist_map_ny + iy];
+
+    float d = (1. - tz) * ((1. - ty) * node[0]            + ty * node[1])
+            +       tz  * ((1. - ty) * node[_dist_map_ny] + ty * node[_dist_map_ny + 1]);
+
+    dist[plane] = (d > 0. ? d : 0.);
+  }
+
+  minDist_U = dist[0];
+  minDist_V = dist[1];
+  minDist_Y = dist[2];
+
+  return true;
+}
+
+
+
+//____________________________________________________________________________________________________
+float FindDeadRegions::ValidateDistanceMap(int n_points) {
+
+  if (!_bwires_loaded) LoadBWires();
+
+  if (!DistanceMapReady()) BuildDistanceMap();
+
+  std::mt19937 generator(12345);
+  std::uniform_real_distribution<float> y_distr(-115., 115.);
+  std::uniform_real_distribution<float> z_distr(0., 1035.);
+
+  float max_dev = 0.;
+  int n_bad_points = 0;
+  int n_bad_2p = 0;
+  int n_bad_3p = 0;
+
+  bool inside;
+
+  for (int n = 0; n < n_points; n++) {
+
+    float y = y_distr(generator);
+    float z = z_distr(generator);
+
+    float map_dist[3];
+    if (!LookUpDistanceMap(y, z, map_dist[0], map_dist[1], map_dist[2])) continue;
+
+    float exact_dist[3];
+    bool bad_point = false;
+
+    for (int plane = 0; plane < 3; plane++) {
+      exact_dist[plane] = ScanPlane(plane, y, z, inside);
+      if (inside) exact_dist[plane] = 0.;
+
+      float dev = fabs(exact_dist[plane] - map_dist[plane]);
+      if (dev > max_dev) max_dev = dev;
+      if (dev > _dist_map_res) bad_point = true;
     }
 
-    if (BWires_V[i].isLowWire == true) {
-      float m_next = (BWires_V[i+1].y_end-BWires_V[i+1].y_start)/(BWires_V[i+1].z_end-BWires_V[i+1].z_start);
-      float b_next = BWires_V[i+1].y_start - m*BWires_V[i+1].z_start;
-      float y1 = m*zVal + b;
-      float y2 = m_next*zVal + b_next;
+    if (bad_point) n_bad_points++;
 
-      if ((yVal >= y1) && (yVal <= y2)) {
-        minDist = 0.0;
-      }
+    int n_close_exact = 0, n_close_map = 0;
+    for (int plane = 0; plane < 3; plane++) {
+      if (exact_dist[plane] < _tolerance) n_close_exact++;
+      if (map_dist[plane] < _tolerance)   n_close_map++;
     }
+
+    if ((n_close_exact >= 2) != (n_close_map >= 2)) n_bad_2p++;
+    if ((n_close_exact >= 1) != (n_close_map >= 1)) n_bad_3p++;
   }
 
-  for (unsigned int i = 0; i < BWires_Y.size(); i++) {
-    float dist = fabs(zVal-BWires_Y[i].z_start);
+  std::cout << "[FindDeadRegions] Distance map validation on " << n_points << " points:" << std::endl;
+  std::cout << "[FindDeadRegions]   max deviation from exact scan: " << max_dev << " cm" << std::endl;
+  std::cout << "[FindDeadRegions]   points deviating more than the resolution: " << n_bad_points << std::endl;
+  std::cout << "[FindDeadRegions]   2P (3P) decisions differing at tolerance " << _tolerance
+            << " cm: " << n_bad_2p << " (" << n_bad_3p << ")" << std::endl;
+
+  if (n_bad_points > 0)
+    std::cerr << "[FindDeadRegions] Distance map does not agree with the exact scan within "
+              << _dist_map_res << " cm, consider a finer DistanceMapResolution." << std::endl;
+
+  return max_dev;
+}
 
-    if (dist < minDist) {
-      minDist = dist;
-    }
 
-    if (BWires_Y[i].isLowWire == true) {
-      float z1 = BWires_Y[i].z_start;
-      float z2 = BWires_Y[i+1].z_start;
 
-      if ((zVal >= z1) && (zVal <= z2)) {
-        minDist = 0.0;
+//__________________________________________________________________________________________________
+void FindDeadRegions::FillDeadRegionHisto(TH2F* h, int n_planes) const {
+
+  int n_bins_z = h->GetNbinsX();
+  int n_bins_y = h->GetNbinsY();
+
+  // Bin centers, converted to float as when passed to NearDeadReg2P/3P
+  std::vector<float> z_center(n_bins_z);
+  std::vector<float> y_center(n_bins_y);
+  for (int i = 1; i <= n_bins_z; i++) z_center[i-1] = h->GetXaxis()->GetBinCenter(i);
+  for (int j = 1; j <= n_bins_y; j++) y_center[j-1] = h->GetYaxis()->GetBinCenter(j);
+
+  float tolerance = _tolerance;
+
+  // One flag per bin, each thread owns a contiguous block of z columns
+  std::vector<unsigned char> dead(n_bins_z * n_bins_y, 0);
+
+  auto fill_columns = [&](int i_start, int i_end) {
+    bool inside;
+    for (int i = i_start; i < i_end; i++) {
+      for (int j = 0; j < n_bins_y; j++) {
+        int n_close = 0;
+        for (int plane = 0; plane < 3; plane++) {
+          float dist = SearchPlane(plane, y_center[j], z_center[i], inside);
+          if (inside) dist = 0.0;
+          if (dist < tolerance) n_close++;
+        }
+        dead[i * n_bins_y + j] = (n_close >= n_planes ? 1 : 0);
       }
     }
+  };
+
+  int n_threads = _n_threads;
+  if (n_threads <= 0) n_threads = std::thread::hardware_concurrency();
+  if (n_threads <= 0) n_threads = 1;
+  n_threads = std::min(n_threads, n_bins_z);
+
+  std::vector<std::thread> workers;
+  int n_columns = (n_bins_z + n_threads - 1) / n_threads;
+  for (int t = 0; t < n_threads; t++) {
+    int i_start = t * n_columns;
+    int i_end = std::min(n_bins_z, i_start + n_columns);
+    if (i_start >= i_end) break;
+    workers.emplace_back(fill_columns, i_start, i_end);
   }
+  for (auto & w : workers) w.join();
 
-  if (minDist < tolerance) {
-    return true;
-  }
-  else {
-    return false;
+  for (int i = 1; i <= n_bins_z; i++) {
+    for (int j = 1; j <= n_bins_y; j++) {
+      if (dead[(i-1) * n_bins_y + (j-1)]) {
+        h->SetBinContent(i,j,1.0);
+      }
+    }
   }
-}
-
 
+  return;
+}
 
 //__________________________________________________________________________________________________
 TH2F* FindDeadRegions::GetDeadRegionHisto2P(){
 
+  if (!_bwires_loaded) LoadBWires();
+
   TH2F *deadReg2P = new TH2F("deadReg2P","",10350,0.0,1035.0,2300,-115.0,115.0);
 
-  for (int i = 1; i <= deadReg2P->GetNbinsX(); i++) {
-    for (int j = 1; j <= deadReg2P->GetNbinsY(); j++) {
-      if (NearDeadReg2P(deadReg2P->GetYaxis()->GetBinCenter(j),deadReg2P->GetXaxis()->GetBinCenter(i),_tolerance) == true) {
-        deadReg2P->SetBinContent(i,j,1.0);
-      }
-    }
-  }
+  FillDeadRegionHisto(deadReg2P, 2);
 
   return deadReg2P;
 }
@@ -557,13 +1039,9 @@ TH2F* FindDeadRegions::GetDeadRegionHisto2P(){
 //__________________________________________________________________________________________________
 void FindDeadRegions::GetDeadRegionHisto2P(TH2F* deadReg2P){
 
-  for (int i = 1; i <= deadReg2P->GetNbinsX(); i++) {
-    for (int j = 1; j <= deadReg2P->GetNbinsY(); j++) {
-      if (NearDeadReg2P(deadReg2P->GetYaxis()->GetBinCenter(j),deadReg2P->GetXaxis()->GetBinCenter(i),_tolerance) == true) {
-        deadReg2P->SetBinContent(i,j,1.0);
-      }
-    }
-  }
+  if (!_bwires_loaded) LoadBWires();
+
+  FillDeadRegionHisto(deadReg2P, 2);
 
   return;
 }
@@ -572,15 +1050,11 @@ void FindDeadRegions::GetDeadRegionHisto2P(TH2F* deadReg2P){
 //__________________________________________________________________________________________________
 TH2F* FindDeadRegions::GetDeadRegionHisto3P(){
 
+  if (!_bwires_loaded) LoadBWires();
+
   TH2F *deadReg3P = new TH2F("deadReg3P","",10350,0.0,1035.0,2300,-115.0,115.0);
 
-  for (int i = 1; i <= deadReg3P->GetNbinsX(); i++) {
-    for (int j = 1; j <= deadReg3P->GetNbinsY(); j++) {
-      if (NearDeadReg3P(deadReg3P->GetYaxis()->GetBinCenter(j),deadReg3P->GetXaxis()->GetBinCenter(i),_tolerance) == true) {
-        deadReg3P->SetBinContent(i,j,1.0);
-      }
-    }
-  }
+  FillDeadRegionHisto(deadReg3P, 1);
 
   return deadReg3P;
 }
@@ -588,13 +1062,9 @@ TH2F* FindDeadRegions::GetDeadRegionHisto3P(){
 //__________________________________________________________________________________________________
 void FindDeadRegions::GetDeadRegionHisto3P(TH2F* deadReg3P){
 
-  for (int i = 1; i <= deadReg3P->GetNbinsX(); i++) {
-    for (int j = 1; j <= deadReg3P->GetNbinsY(); j++) {
-      if (NearDeadReg3P(deadReg3P->GetYaxis()->GetBinCenter(j),deadReg3P->GetXaxis()->GetBinCenter(i),_tolerance) == true) {
-        deadReg3P->SetBinContent(i,j,1.0);
-      }
-    }
-  }
+  if (!_bwires_loaded) LoadBWires();
+
+  FillDeadRegionHisto(deadReg3P, 1);
 
   return;
 }
@@ -22,6 +22,10 @@
 #include "lardataobj/RecoBase/PFParticle.h"
 #include "larpandora/LArPandoraInterface/LArPandoraHelper.h"
 
+#include "TVector3.h"
+
+#include "WireProjector.h"
+
 struct BoundaryWire {
   unsigned int wire_num;
   float y_start;
@@ -31,6 +35,34 @@ struct BoundaryWire {
   bool isLowWire;
 };
 
+/// Boundary wires of one plane sorted along the coordinate perpendicular to the wires
+struct BoundaryIndex {
+  float dir_y = 1.;                     ///< Wire direction (y component)
+  float dir_z = 0.;                     ///< Wire direction (z component)
+  std::vector<float> m;                 ///< Slope of each boundary wire (y = m*z + b), U and V planes only
+  std::vector<float> b;                 ///< Intercept of each boundary wire, U and V planes only
+  std::vector<double> norm;             ///< sqrt(m^2+1) of each boundary wire, U and V planes only
+  std::vector<float> coord;             ///< Sorted boundary wire coordinates
+  std::vector<unsigned int> coord_wire; ///< Boundary wire index of each entry in coord
+  std::vector<float> band_start;        ///< Sorted lower coordinate of each dead band
+  std::vector<float> band_end;          ///< Upper coordinate of each entry in band_start
+  std::vector<unsigned int> band_wire;  ///< Boundary wire index of the low wire of each entry in band_start
+};
+
+/// Length of a trajectory lying within dead regions
+struct DeadRegionPathLength {
+  double length = 0.;                   ///< Total length of the trajectory (cm)
+  double dead_length[3] = {0., 0., 0.}; ///< Length within a dead region on the U, V and Y planes (cm)
+  double dead_length_2p = 0.;           ///< Length within a dead region on at least two planes (cm)
+  double dead_length_any = 0.;          ///< Length within a dead region on at least one plane (cm)
+
+  /// Fraction of the trajectory within a dead region on one plane
+  double DeadFraction(int plane) const { return (length > 0. ? dead_length[plane] / length : 0.); }
+
+  /// Fraction of the trajectory within a dead region on at least two planes
+  double DeadFraction2P() const { return (length > 0. ? dead_length_2p / length : 0.); }
+};
+
 class FindDeadRegions;
 
 class FindDeadRegions {
@@ -42,6 +74,38 @@ public:
   /// Configure function parameters
   void Configure(fhicl::ParameterSet const& p);
 
+  /// Returns the distance (cm) of the passed point from the closest dead region on each plane (0 if inside one)
+  void GetMinDistances(float yVal, float zVal, float & minDist_U, float & minDist_V, float & minDist_Y);
+
+  /**
+   *  @brief Batch version of GetMinDistances, always exact
+   *
+   *  @param yVal the y coordinates of the points
+   *  @param zVal the z coordinates of the points
+   *  @param tolerance the tolerance in cm used to fill the plane mask
+   *  @param minDist_U output, distance from the closest dead region on the U plane for each point
+   *  @param minDist_V output, distance from the closest dead region on the V plane for each point
+   *  @param minDist_Y output, distance from the closest dead region on the Y plane for each point
+   *  @param plane_mask output, for each point bit 0 (1, 2) is set if the point is closer than tolerance to a dead region on U (V, Y)
+   */
+  void GetMinDistances(std::vector<float> const& yVal, std::vector<float> const& zVal, float tolerance,
+                       std::vector<float> & minDist_U, std::vector<float> & minDist_V, std::vector<float> & minDist_Y,
+                       std::vector<unsigned int> & plane_mask);
+
+  /**
+   *  @brief Integrates the length of a trajectory lying within dead regions, per plane
+   *
+   *  Each segment between consecutive points is intersected analytically with
+   *  the dead bands of each plane, which are widened by tolerance on both sides.
+   *
+   *  @param points the trajectory points
+   *  @param tolerance the tolerance in cm
+   */
+  DeadRegionPathLength GetDeadPathLength(std::vector<TVector3> const& points, float tolerance = 0.);
+
+  /// Same as above, using the trajectory points of a track
+  DeadRegionPathLength GetDeadPathLength(recob::Track const& track, float tolerance = 0.);
+
   /// Returns true if the passed point is close to a dead region given a tolerance considering two planes only
   bool NearDeadReg2P(float yVal, float zVal, float tolerance);
 
@@ -60,17 +124,118 @@ public:
   /// Returns a root 2D histogram (y v.s. z) containing the detector dead regions considering all three planes
   void GetDeadRegionHisto3P(TH2F *);
 
+  /**
+   *  @brief Returns true if a bad channel is within window channels from the passed one, on the same plane
+   *
+   *  Answered from a per-plane prefix sum of the bad channels, built with the channel statuses.
+   *
+   *  @param ch the channel to check
+   *  @param window the number of channels checked on each side
+   */
+  bool ChannelNearBadChannel(unsigned int ch, int window);
+
+  /// Returns the projection of (y,z) points to wire numbers, built from the cached wire end points
+  const ubxsec::WireProjector & GetWireProjector();
+
+  /**
+   *  @brief Loads the boundary wires, and builds the distance map if it is used
+   *
+   *  The queries load these lazily. After this call they only read the
+   *  object, so they can be called from more than one thread.
+   */
+  void Prepare();
+
+  /**
+   *  @brief Reloads the channel statuses and rebuilds the boundary wires of the planes where they changed
+   *
+   *  @return true if at least one plane was rebuilt
+   */
+  bool UpdateChannelStatus();
+
+  /// Compares the distance map to the exact boundary-wire scan on random points, returns the max deviation (cm)
+  float ValidateDistanceMap(int n_points = 100000);
+
 private:
 
   void LoadBWires();
 
+  /// Returns the full path of the snapshot file
+  std::string SnapshotPath() const;
+
+  /// Caches the wire end points of all the channels, from the geometry or from file
+  void LoadGeometry();
+
+  /// Fills the channel statuses (true if good), from the database or from file
+  void LoadChannelStatus(std::vector<bool> & status);
+
+  /// Fills the prefix sum of the bad channels of one plane from the channel statuses
+  void BuildBadChannelCount(int plane, std::vector<bool> const& status);
+
+  /// Builds the boundary wires of one plane from the channel statuses
+  void BuildBWires(int plane, std::vector<bool> const& status);
+
+  /// Exact scan over the boundary wires of one plane: returns the distance to the closest boundary wire
+  float ScanPlane(int plane, float yVal, float zVal, bool & inside) const;
+
+  /// Builds the sorted boundary wire index for one plane
+  void BuildBoundaryIndex(int plane);
+
+  /// Same as ScanPlane but using the sorted boundary wire index (binary search)
+  float SearchPlane(int plane, float yVal, float zVal, bool & inside) const;
+
+  /// Returns true if the point lies between the low boundary wire i and the following one
+  bool InBand(int plane, unsigned int i, float yVal, float zVal) const;
+
+  /// Fills the histogram bins within tolerance from a dead region on at least n_planes planes, using _n_threads threads
+  void FillDeadRegionHisto(TH2F * h, int n_planes) const;
+
+  /// Fills the per-plane signed distance map (negative inside dead regions)
+  void BuildDistanceMap();
+
+  /// Returns true if the distance map is up to date on all planes
+  bool DistanceMapReady() const;
+
+  /// Bilinear lookup in the distance map, returns false if the point is outside the map
+  bool LookUpDistanceMap(float yVal, float zVal, float & minDist_U, float & minDist_V, float & minDist_Y) const;
+
   std::vector<BoundaryWire> BWires_U; ///< Contains list of wires marking the boundaries of dead regions (U plane)
   std::vector<BoundaryWire> BWires_V; ///< Contains list of wires marking the boundaries of dead regions (V plane)
   std::vector<BoundaryWire> BWires_Y; ///< Contains list of wires marking the boundaries of dead regions (Y plane)
 
+  const int _plane_first_ch[4] = {0, 2400, 4800, 8256}; ///< First channel of each plane (and total number of channels)
+
+  bool _bwires_loaded = false;     ///< True if the boundary wires are built
+  bool _geometry_loaded = false;   ///< True if the wire end points are cached
+  std::vector<unsigned int> _ch_wire; ///< Wire number of each channel
+  std::vector<float> _ch_sy;       ///< Wire start y of each channel
+  std::vector<float> _ch_sz;       ///< Wire start z of each channel
+  std::vector<float> _ch_ey;       ///< Wire end y of each channel
+  std::vector<float> _ch_ez;       ///< Wire end z of each channel
+  ubxsec::WireProjector _wire_projector; ///< Projection to wire numbers, from the wire end points
+  std::vector<bool> _ch_status;    ///< Status (true if good) of each channel used to build the boundary wires
+  std::vector<unsigned int> _ch_bad_count; ///< Number of bad channels before each channel on its plane (one extra entry per plane)
+
+  BoundaryIndex _bwires_index[3];    ///< Sorted boundary wire index for each plane
+
   bool _use_file = false;  ///< If true, uses input files instad of geometry and database
+  std::string _geo_file;      ///< Wire geometry text file (if _use_file)
+  std::string _status_file;   ///< Channel status text file (if _use_file)
+  std::string _snapshot_file; ///< Binary snapshot with geometry and statuses, used instead of everything else if set
   double _tolerance = 0.6; ///< Tolerance in cm to claim a point is in a dead region
   int _ch_thres = 4;       ///< Channels with status _less_ than threshold are considered as bad (only if using database)
+
+  int _n_threads = 0;      ///< Number of threads used to fill the dead region histograms (0: one per core)
+
+  bool _use_dist_map = false;      ///< If true, queries are answered by a bilinear lookup in a precomputed distance map
+  double _dist_map_res = 0.5;      ///< Distance map grid spacing in cm
+  bool _validate_dist_map = false; ///< If true, compares the distance map to the exact scan after building it
+  bool _dist_map_ready[3] = {false, false, false}; ///< True if the distance map is up to date with the boundary wires, per plane
+
+  float _dist_map_y_min = -117.5;  ///< Lower y edge of the distance map
+  float _dist_map_z_min = -1.;     ///< Lower z edge of the distance map
+  int _dist_map_ny = 0;            ///< Number of grid nodes in y
+  int _dist_map_nz = 0;            ///< Number of grid nodes in z
+  std::vector<float> _dist_map[3]; ///< Signed distance on the grid nodes for each plane, z-major
 };
 
 #endif
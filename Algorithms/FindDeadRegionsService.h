@@ -0,0 +1,53 @@
+/**
+ * \file FindDeadRegionsService.h
+ *
+ * \ingroup UBXSec
+ *
+ * \brief Service holding a run-scoped FindDeadRegions instance
+ *
+ * @author Marco Del Tutto
+ */
+
+/** \addtogroup UBXSec
+
+    @{*/
+
+#ifndef FINDDEADREGIONSSERVICE_H
+#define FINDDEADREGIONSSERVICE_H
+
+#include "art/Framework/Services/Registry/ActivityRegistry.h"
+#include "art/Framework/Services/Registry/ServiceMacros.h"
+#include "art/Framework/Principal/Run.h"
+#include "art/Framework/Principal/Event.h"
+#include "fhiclcpp/ParameterSet.h"
+
+#include "uboone/UBXSec/Algorithms/FindDeadRegions.h"
+
+/**
+ * Shares one FindDeadRegions between all the modules of a job.
+ * The channel statuses are checked again at the first use after each
+ * new run (or after each event if CheckEveryEvent is set), so that the
+ * database provider already points to the right interval of validity.
+ * Boundary wires are rebuilt only on the planes where a status changed.
+ */
+class FindDeadRegionsService {
+public:
+  explicit FindDeadRegionsService(fhicl::ParameterSet const & p, art::ActivityRegistry & areg);
+
+  /// Returns the dead region finder, up to date with the current channel statuses
+  FindDeadRegions & GetProvider();
+
+private:
+
+  void preBeginRun(art::Run const& run);
+  void preProcessEvent(art::Event const& evt);
+
+  FindDeadRegions _finder;
+  bool _update_pending = true;     ///< If true, channel statuses are checked at the next GetProvider call
+  bool _check_every_event = false; ///< If true, channel statuses are checked every event instead of every run
+};
+
+DECLARE_ART_SERVICE(FindDeadRegionsService, LEGACY)
+
+#endif
+/** @} */ // end of doxygen group
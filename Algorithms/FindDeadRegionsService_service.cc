@@ -0,0 +1,45 @@
+////////////////////////////////////////////////////////////////////////
+// Class:       FindDeadRegionsService
+// Plugin Type: service (art v2_05_00)
+// File:        FindDeadRegionsService_service.cc
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "FindDeadRegionsService.h"
+
+FindDeadRegionsService::FindDeadRegionsService(fhicl::ParameterSet const & p, art::ActivityRegistry & areg)
+{
+  _finder.Configure(p);
+
+  _check_every_event = p.get<bool>("CheckEveryEvent", false);
+
+  areg.sPreBeginRun.watch(this, &FindDeadRegionsService::preBeginRun);
+  areg.sPreProcessEvent.watch(this, &FindDeadRegionsService::preProcessEvent);
+}
+
+//___________________________________________________________________________________________________
+void FindDeadRegionsService::preBeginRun(art::Run const& run)
+{
+  _update_pending = true;
+}
+
+//___________________________________________________________________________________________________
+void FindDeadRegionsService::preProcessEvent(art::Event const& evt)
+{
+  if (_check_every_event) _update_pending = true;
+}
+
+//___________________________________________________________________________________________________
+FindDeadRegions & FindDeadRegionsService::GetProvider()
+{
+  // Statuses are read lazily, when the channel status service
+  // is already updated to the current event
+  if (_update_pending) {
+    _finder.UpdateChannelStatus();
+    _update_pending = false;
+  }
+
+  return _finder;
+}
+
+DEFINE_ART_SERVICE(FindDeadRegionsService)
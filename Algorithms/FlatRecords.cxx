@@ -0,0 +1,132 @@
+#ifndef FLATRECORDS_CXX
+#define FLATRECORDS_CXX
+
+#include "FlatRecords.h"
+
+#include <algorithm>
+#include <string>
+
+namespace {
+
+  /// Creates a branch with a single leaf named as the branch, type is the ROOT leaf type (I, F, O, L)
+  void Leaf(TTree * tree, std::string const & name, void * address, std::string const & type, int basket_size)
+  {
+    tree->Branch(name.c_str(), address, (name + "/" + type).c_str(), basket_size);
+  }
+
+  /// Creates a branch with a fixed-size float array leaf
+  void SpecLeaf(TTree * tree, std::string const & name, float * address, int basket_size)
+  {
+    tree->Branch(name.c_str(), address, (name + "[" + std::to_string(ubxsec::kFlatNPMTs) + "]/F").c_str(), basket_size);
+  }
+}
+
+namespace ubxsec {
+
+  void FillFlatSpec(std::vector<double> const & spec, float * out)
+  {
+    size_t n = std::min(spec.size(), (size_t)kFlatNPMTs);
+    for (size_t i = 0; i < n; i++) out[i] = spec[i];
+    for (size_t i = n; i < (size_t)kFlatNPMTs; i++) out[i] = 0.;
+  }
+
+  //___________________________________________________________________________________________________
+  void FlatEventRecord::Branch(TTree * tree, int basket_size)
+  {
+    Leaf(tree, "run",                        &run,                        "I", basket_size);
+    Leaf(tree, "subrun",                     &subrun,                     "I", basket_size);
+    Leaf(tree, "event",                      &event,                      "I", basket_size);
+    Leaf(tree, "is_reco",                    &is_reco,                    "I", basket_size);
+    Leaf(tree, "reco_purity",                &reco_purity,                "F", basket_size);
+    Leaf(tree, "reco_efficiency",            &reco_efficiency,            "F", basket_size);
+    Leaf(tree, "true_momentum",              &true_momentum,              "F", basket_size);
+    Leaf(tree, "true_momentum_matched",      &true_momentum_matched,      "F", basket_size);
+    Leaf(tree, "nPFPtagged",                 &nPFPtagged,                 "I", basket_size);
+    Leaf(tree, "is_flash_tagged",            &is_flash_tagged,            "I", basket_size);
+    Leaf(tree, "tag_score",                  &tag_score,                  "F", basket_size);
+    Leaf(tree, "fm_score",                   &fm_score,                   "F", basket_size);
+    Leaf(tree, "fv",                         &fv,                         "I", basket_size);
+    Leaf(tree, "ccnc",                       &ccnc,                       "I", basket_size);
+    Leaf(tree, "nupdg",                      &nupdg,                      "I", basket_size);
+    Leaf(tree, "nu_e",                       &nu_e,                       "F", basket_size);
+    Leaf(tree, "reco_start_x",               &reco_start_x,               "F", basket_size);
+    Leaf(tree, "reco_start_y",               &reco_start_y,               "F", basket_size);
+    Leaf(tree, "reco_start_z",               &reco_start_z,               "F", basket_size);
+    Leaf(tree, "reco_end_x",                 &reco_end_x,                 "F", basket_size);
+    Leaf(tree, "reco_end_y",                 &reco_end_y,                 "F", basket_size);
+    Leaf(tree, "reco_end_z",                 &reco_end_z,                 "F", basket_size);
+    Leaf(tree, "mc_start_x",                 &mc_start_x,                 "F", basket_size);
+    Leaf(tree, "mc_start_y",                 &mc_start_y,                 "F", basket_size);
+    Leaf(tree, "mc_start_z",                 &mc_start_z,                 "F", basket_size);
+    Leaf(tree, "mc_end_x",                   &mc_end_x,                   "F", basket_size);
+    Leaf(tree, "mc_end_y",                   &mc_end_y,                   "F", basket_size);
+    Leaf(tree, "mc_end_z",                   &mc_end_z,                   "F", basket_size);
+    Leaf(tree, "mc_contained",               &mc_contained,               "I", basket_size);
+    Leaf(tree, "is_golden",                  &is_golden,                  "I", basket_size);
+    Leaf(tree, "is_swtriggered",             &is_swtriggered,             "I", basket_size);
+    Leaf(tree, "vtx_resolution",             &vtx_resolution,             "F", basket_size);
+    Leaf(tree, "nslices",                    &nslices,                    "I", basket_size);
+    Leaf(tree, "nbeamfls",                   &nbeamfls,                   "I", basket_size);
+    Leaf(tree, "nsignal",                    &nsignal,                    "I", basket_size);
+    Leaf(tree, "no_mcflash_but_op_activity", &no_mcflash_but_op_activity, "O", basket_size);
+    SpecLeaf(tree, "numc_flash_spec", numc_flash_spec, basket_size);
+  }
+
+  //___________________________________________________________________________________________________
+  void FlatSliceRecord::Branch(TTree * tree, int basket_size)
+  {
+    Leaf(tree, "event_entry",                   &event_entry,               "L", basket_size);
+    Leaf(tree, "run",                           &run,                       "I", basket_size);
+    Leaf(tree, "subrun",                        &subrun,                    "I", basket_size);
+    Leaf(tree, "event",                         &event,                     "I", basket_size);
+    Leaf(tree, "slice",                         &slice,                     "I", basket_size);
+    Leaf(tree, "slc_flsmatch_score",            &flsmatch_score,            "F", basket_size);
+    Leaf(tree, "slc_flsmatch_qllx",             &flsmatch_qllx,             "F", basket_size);
+    Leaf(tree, "slc_flsmatch_tpcx",             &flsmatch_tpcx,             "F", basket_size);
+    Leaf(tree, "slc_flsmatch_t0",               &flsmatch_t0,               "F", basket_size);
+    Leaf(tree, "slc_flsmatch_hypoz",            &flsmatch_hypoz,            "F", basket_size);
+    Leaf(tree, "slc_flsmatch_xfixed_chi2",      &flsmatch_xfixed_chi2,      "F", basket_size);
+    Leaf(tree, "slc_flsmatch_xfixed_ll",        &flsmatch_xfixed_ll,        "F", basket_size);
+    Leaf(tree, "slc_flsmatch_cosmic_score",     &flsmatch_cosmic_score,     "F", basket_size);
+    Leaf(tree, "slc_flsmatch_cosmic_t0",        &flsmatch_cosmic_t0,        "F", basket_size);
+    Leaf(tree, "slc_nuvtx_x",                   &nuvtx_x,                   "F", basket_size);
+    Leaf(tree, "slc_nuvtx_y",                   &nuvtx_y,                   "F", basket_size);
+    Leaf(tree, "slc_nuvtx_z",                   &nuvtx_z,                   "F", basket_size);
+    Leaf(tree, "slc_nuvtx_fv",                  &nuvtx_fv,                  "I", basket_size);
+    Leaf(tree, "slc_vtxcheck_angle",            &vtxcheck_angle,            "F", basket_size);
+    Leaf(tree, "slc_origin",                    &origin,                    "I", basket_size);
+    Leaf(tree, "slc_nhits_u",                   &nhits_u,                   "I", basket_size);
+    Leaf(tree, "slc_nhits_v",                   &nhits_v,                   "I", basket_size);
+    Leaf(tree, "slc_nhits_w",                   &nhits_w,                   "I", basket_size);
+    Leaf(tree, "slc_longesttrack_length",       &longesttrack_length,       "F", basket_size);
+    Leaf(tree, "slc_longesttrack_deadfraction", &longesttrack_deadfraction, "F", basket_size);
+    Leaf(tree, "slc_acpt_outoftime",            &acpt_outoftime,            "I", basket_size);
+    Leaf(tree, "slc_crosses_top_boundary",      &crosses_top_boundary,      "I", basket_size);
+    Leaf(tree, "slc_nuvtx_closetodeadregion_u", &nuvtx_closetodeadregion_u, "I", basket_size);
+    Leaf(tree, "slc_nuvtx_closetodeadregion_v", &nuvtx_closetodeadregion_v, "I", basket_size);
+    Leaf(tree, "slc_nuvtx_closetodeadregion_w", &nuvtx_closetodeadregion_w, "I", basket_size);
+    Leaf(tree, "slc_kalman_chi2",               &kalman_chi2,               "F", basket_size);
+    Leaf(tree, "slc_kalman_ndof",               &kalman_ndof,               "I", basket_size);
+    Leaf(tree, "slc_passed_min_track_quality",  &passed_min_track_quality,  "O", basket_size);
+    Leaf(tree, "slc_n_intime_pe_closestpmt",    &n_intime_pe_closestpmt,    "F", basket_size);
+    Leaf(tree, "slc_maxdistance_vtxtrack",      &maxdistance_vtxtrack,      "F", basket_size);
+    SpecLeaf(tree, "slc_flshypo_spec",        flshypo_spec,        basket_size);
+    SpecLeaf(tree, "slc_flshypo_xfixed_spec", flshypo_xfixed_spec, basket_size);
+  }
+
+  //___________________________________________________________________________________________________
+  void FlatFlashRecord::Branch(TTree * tree, int basket_size)
+  {
+    Leaf(tree, "event_entry",  &event_entry,  "L", basket_size);
+    Leaf(tree, "run",          &run,          "I", basket_size);
+    Leaf(tree, "subrun",       &subrun,       "I", basket_size);
+    Leaf(tree, "event",        &event,        "I", basket_size);
+    Leaf(tree, "flash",        &flash,        "I", basket_size);
+    Leaf(tree, "beamfls_time", &beamfls_time, "F", basket_size);
+    Leaf(tree, "beamfls_pe",   &beamfls_pe,   "F", basket_size);
+    Leaf(tree, "beamfls_z",    &beamfls_z,    "F", basket_size);
+    SpecLeaf(tree, "beamfls_spec", beamfls_spec, basket_size);
+  }
+}
+
+#endif
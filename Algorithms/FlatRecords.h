@@ -0,0 +1,116 @@
+/**
+ * \file FlatRecords.h
+ *
+ * \ingroup UBXSec
+ *
+ * \brief Fixed-size event, slice and flash records for the flat UBXSec trees
+ *
+ * @author Marco Del Tutto
+ */
+
+/** \addtogroup UBXSec
+
+    @{*/
+
+#ifndef FLATRECORDS_H
+#define FLATRECORDS_H
+
+#include <iostream>
+#include <vector>
+
+#include "TTree.h"
+
+namespace ubxsec {
+
+  /// Size of the per-PMT arrays in the flat trees
+  const int kFlatNPMTs = 32;
+
+  /// Copies a per-PMT spectrum into a fixed array, missing entries are set to 0
+  void FillFlatSpec(std::vector<double> const & spec, float * out);
+
+  /**
+   * \struct FlatEventRecord
+   *
+   * One entry per event of the flat event tree. Only plain leaves: each
+   * member is a branch with the same name as in the nested UBXSec tree.
+   * Floating point quantities are stored as float.
+   */
+  struct FlatEventRecord {
+
+    int   run, subrun, event;
+    int   is_reco;
+    float reco_purity, reco_efficiency;
+    float true_momentum, true_momentum_matched;
+    int   nPFPtagged, is_flash_tagged;
+    float tag_score, fm_score;
+    int   fv, ccnc, nupdg;
+    float nu_e;
+    float reco_start_x, reco_start_y, reco_start_z;
+    float reco_end_x, reco_end_y, reco_end_z;
+    float mc_start_x, mc_start_y, mc_start_z;
+    float mc_end_x, mc_end_y, mc_end_z;
+    int   mc_contained, is_golden, is_swtriggered;
+    float vtx_resolution;
+    int   nslices, nbeamfls, nsignal;
+    bool  no_mcflash_but_op_activity;
+    float numc_flash_spec[kFlatNPMTs];
+
+    /// Creates the branches on the tree, pointing to this record
+    void Branch(TTree * tree, int basket_size);
+  };
+
+  /**
+   * \struct FlatSliceRecord
+   *
+   * One entry per slice of the flat slice tree. event_entry is the entry of
+   * the event in the flat event tree. The branches keep the names of the
+   * nested tree (slc_ prefix), so selection strings can be reused.
+   */
+  struct FlatSliceRecord {
+
+    Long64_t event_entry;
+    int   run, subrun, event;
+    int   slice;
+    float flsmatch_score, flsmatch_qllx, flsmatch_tpcx, flsmatch_t0, flsmatch_hypoz;
+    float flsmatch_xfixed_chi2, flsmatch_xfixed_ll;
+    float flsmatch_cosmic_score, flsmatch_cosmic_t0;
+    float nuvtx_x, nuvtx_y, nuvtx_z;
+    int   nuvtx_fv;
+    float vtxcheck_angle;
+    int   origin;
+    int   nhits_u, nhits_v, nhits_w;
+    float longesttrack_length, longesttrack_deadfraction;
+    int   acpt_outoftime, crosses_top_boundary;
+    int   nuvtx_closetodeadregion_u, nuvtx_closetodeadregion_v, nuvtx_closetodeadregion_w;
+    float kalman_chi2;
+    int   kalman_ndof;
+    bool  passed_min_track_quality;
+    float n_intime_pe_closestpmt, maxdistance_vtxtrack;
+    float flshypo_spec[kFlatNPMTs];
+    float flshypo_xfixed_spec[kFlatNPMTs];
+
+    /// Creates the branches on the tree, pointing to this record
+    void Branch(TTree * tree, int basket_size);
+  };
+
+  /**
+   * \struct FlatFlashRecord
+   *
+   * One entry per beam flash of the flat flash tree. event_entry is the
+   * entry of the event in the flat event tree.
+   */
+  struct FlatFlashRecord {
+
+    Long64_t event_entry;
+    int   run, subrun, event;
+    int   flash;
+    float beamfls_time, beamfls_pe, beamfls_z;
+    float beamfls_spec[kFlatNPMTs];
+
+    /// Creates the branches on the tree, pointing to this record
+    void Branch(TTree * tree, int basket_size);
+  };
+}
+
+#endif //  FLATRECORDS_H
+/** @} */ // end of doxygen group
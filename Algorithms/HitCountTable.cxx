@@ -0,0 +1,45 @@
+#ifndef HITCOUNTTABLE_CXX
+#define HITCOUNTTABLE_CXX
+
+#include "HitCountTable.h"
+
+#include <algorithm>
+
+namespace ubxsec {
+
+  template <typename ObjToHitsMap>
+  void HitCountTable::FillFromMap(ObjToHitsMap const & obj_to_hits)
+  {
+    _table.clear();
+
+    size_t max_key = 0;
+    for (auto const & iter : obj_to_hits) max_key = std::max(max_key, iter.first.key());
+    if (!obj_to_hits.empty()) _table.resize(max_key + 1);
+
+    for (auto const & iter : obj_to_hits) {
+
+      HitCounts & counts = _table[iter.first.key()];
+
+      for (auto const & hit : iter.second) {
+        int view = hit->View();
+        if (view < 0 || view > 2) continue;
+        counts.n_hits[view]++;
+        counts.integral[view] += hit->Integral();
+      }
+    }
+  }
+
+  //___________________________________________________________________________________________________
+  void HitCountTable::Fill(lar_pandora::TracksToHits const & tracks_to_hits)
+  {
+    FillFromMap(tracks_to_hits);
+  }
+
+  //___________________________________________________________________________________________________
+  void HitCountTable::Fill(lar_pandora::ShowersToHits const & showers_to_hits)
+  {
+    FillFromMap(showers_to_hits);
+  }
+}
+
+#endif
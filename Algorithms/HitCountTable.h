@@ -0,0 +1,90 @@
+/**
+ * \file HitCountTable.h
+ *
+ * \ingroup UBXSec
+ *
+ * \brief Dense per-object, per-plane hit counts and integrals
+ *
+ * @author Marco Del Tutto
+ */
+
+/** \addtogroup UBXSec
+
+    @{*/
+
+#ifndef HITCOUNTTABLE_H
+#define HITCOUNTTABLE_H
+
+#include <iostream>
+#include <vector>
+
+#include "larpandora/LArPandoraInterface/LArPandoraHelper.h"
+
+namespace ubxsec {
+
+  /// Number of hits and summed hit integral on each plane (U, V, W) for a reco object
+  struct HitCounts {
+    int   n_hits[3]   = {0, 0, 0};
+    float integral[3] = {0., 0., 0.};
+
+    /// Returns true if at least one plane has more than nHitsReq hits
+    bool PassesHitRequirement(int nHitsReq) const {
+      return (n_hits[0] > nHitsReq) || (n_hits[1] > nHitsReq) || (n_hits[2] > nHitsReq);
+    }
+  };
+
+  /**
+   * \class HitCountTable
+   *
+   * Built in one pass over a reco object -> hits map (tracks or showers),
+   * stores the hit counts per plane in a table indexed by the art::Ptr key
+   * of the object, so that hit requirements and per-plane counts are
+   * constant time lookups.
+   */
+  class HitCountTable {
+
+  public:
+
+    /// Default constructor
+    HitCountTable() = default;
+
+    /// Default destructor
+    ~HitCountTable(){}
+
+    /// Fills the table from a track -> hits map
+    void Fill(lar_pandora::TracksToHits const & tracks_to_hits);
+
+    /// Fills the table from a shower -> hits map
+    void Fill(lar_pandora::ShowersToHits const & showers_to_hits);
+
+    /// Returns the counts for the object with key passed (all zeros if not in the table)
+    HitCounts const & Get(size_t key) const { return (key < _table.size() ? _table[key] : _empty); }
+
+    /// Returns the number of hits on a plane for the object with key passed
+    int GetNHits(size_t key, int plane) const { return Get(key).n_hits[plane]; }
+
+    /// Returns the summed hit integral on a plane for the object with key passed
+    float GetIntegral(size_t key, int plane) const { return Get(key).integral[plane]; }
+
+    /// Returns true if the object with key passed has more than nHitsReq hits in at least one plane
+    bool PassesHitRequirement(size_t key, int nHitsReq) const { return Get(key).PassesHitRequirement(nHitsReq); }
+
+    /// Returns the size of the table (max key + 1)
+    size_t size() const { return _table.size(); }
+
+    /// Empties the table
+    void Clear() { _table.clear(); }
+
+  private:
+
+    /// Fills the entries in the table from a generic object -> hits map
+    template <typename ObjToHitsMap>
+    void FillFromMap(ObjToHitsMap const & obj_to_hits);
+
+    std::vector<HitCounts> _table; ///< Indexed by the art::Ptr key
+    HitCounts _empty;              ///< Returned for keys not in the table
+  };
+}
+
+#endif //  HITCOUNTTABLE_H
+/** @} */ // end of doxygen group
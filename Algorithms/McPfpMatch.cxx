@@ -41,6 +41,43 @@
 
 
 
+namespace {
+
+  /// As LArPandoraHelper::BuildMCParticleHitMaps with kAddDaughters, with the hits backtracked from the SimChannel index
+  void BuildMCParticleHitMaps(ubxsec::SimChannelBackTracker const & simch_bt,
+                              lar_pandora::HitVector const & hitVector,
+                              lar_pandora::MCParticleVector const & particleVector,
+                              lar_pandora::MCParticlesToHits & particlesToHits,
+                              lar_pandora::HitsToMCParticles & hitsToParticles) {
+
+    lar_pandora::MCParticleMap particleMap;
+    lar_pandora::LArPandoraHelper::BuildMCParticleMap(particleVector, particleMap);
+
+    for (auto const & hit : hitVector) {
+
+      // The track ID with the largest fraction of the hit energy
+      int bestTrackID = -1;
+      float bestEnergyFrac = 0.;
+      for (auto const & tide : simch_bt.HitToTrackID(hit)) {
+        if (tide.energyFrac > bestEnergyFrac) {
+          bestEnergyFrac = tide.energyFrac;
+          bestTrackID = tide.trackID;
+        }
+      }
+      if (bestTrackID < 0) continue;
+
+      auto iter = particleMap.find(bestTrackID);
+      if (iter == particleMap.end()) continue;
+
+      const art::Ptr<simb::MCParticle> particle = lar_pandora::LArPandoraHelper::GetFinalStateMCParticle(particleMap, iter->second);
+      if (!lar_pandora::LArPandoraHelper::IsVisible(particle)) continue;
+
+      hitsToParticles[hit] = particle;
+      particlesToHits[particle].push_back(hit);
+    }
+  }
+}
+
 namespace ubxsec {
 
   McPfpMatch::McPfpMatch(){
@@ -49,6 +86,18 @@ namespace ubxsec {
 
   void McPfpMatch::Configure(art::Event const & e, std::string _pfp_producer, std::string _spacepointLabel, std::string _hitfinderLabel, std::string _geantModuleLabel) {
 
+    Configure(e, _pfp_producer, _spacepointLabel, _hitfinderLabel, _geantModuleLabel, nullptr);
+  }
+
+  //___________________________________________________________________________________________________
+  void McPfpMatch::Configure(art::Event const & e, std::string _pfp_producer, std::string _spacepointLabel, std::string _hitfinderLabel, std::string _geantModuleLabel, SimChannelBackTracker const & simch_bt) {
+
+    Configure(e, _pfp_producer, _spacepointLabel, _hitfinderLabel, _geantModuleLabel, &simch_bt);
+  }
+
+  //___________________________________________________________________________________________________
+  void McPfpMatch::Configure(art::Event const & e, std::string _pfp_producer, std::string _spacepointLabel, std::string _hitfinderLabel, std::string _geantModuleLabel, SimChannelBackTracker const * simch_bt) {
+
     bool _debug = true;
 
     // Collect hits
@@ -80,7 +129,10 @@ namespace ubxsec {
     if (!e.isRealData()) {
       lar_pandora::LArPandoraHelper::CollectMCParticles(e, _geantModuleLabel, trueParticleVector);
       lar_pandora::LArPandoraHelper::CollectMCParticles(e, _geantModuleLabel, truthToParticles, particlesToTruth);
-      lar_pandora::LArPandoraHelper::BuildMCParticleHitMaps(e, _geantModuleLabel, hitVector, trueParticlesToHits, trueHitsToParticles, lar_pandora::LArPandoraHelper::kAddDaughters);
+      if (simch_bt)
+        BuildMCParticleHitMaps(*simch_bt, hitVector, trueParticleVector, trueParticlesToHits, trueHitsToParticles);
+      else
+        lar_pandora::LArPandoraHelper::BuildMCParticleHitMaps(e, _geantModuleLabel, hitVector, trueParticlesToHits, trueHitsToParticles, lar_pandora::LArPandoraHelper::kAddDaughters);
     }
 
     if (_debug) {
@@ -89,8 +141,7 @@ namespace ubxsec {
     }  
 
     // Now set the things we need for the future
-    _trueHitsToParticles = trueHitsToParticles;
-    _recoParticlesToHits = recoParticlesToHits;
+    _matcher.Configure(recoParticlesToHits, trueHitsToParticles);
 
     if (false) { // yes, don't do it
       std::cout << "[McPfpMatch] This is event " << e.id().run() << std::endl;
@@ -115,13 +166,10 @@ namespace ubxsec {
 
   //___________________________________________________________________________________________________
   void McPfpMatch::GetRecoToTrueMatches(lar_pandora::MCParticlesToPFParticles &matchedParticles,
-                                        lar_pandora::MCParticlesToHits &matchedParticleHits) {
-  
- 
-    GetRecoToTrueMatches(_recoParticlesToHits,
-                         _trueHitsToParticles,
-                         matchedParticles,
-                         matchedParticleHits);
+                                        lar_pandora::MCParticlesToHits &matchedParticleHits,
+                                        bool recursiveMatching) {
+
+    _matcher.Match(matchedParticles, matchedParticleHits, recursiveMatching);
   }
   
   
@@ -146,76 +194,9 @@ namespace ubxsec {
                                              MCParticleSet &vetoTrue,
                                              bool _recursiveMatching) 
   {
-      bool foundMatches(false);
-  
-      // Loop over the reco particles
-      for (lar_pandora::PFParticlesToHits::const_iterator iter1 = recoParticlesToHits.begin(), iterEnd1 = recoParticlesToHits.end();
-          iter1 != iterEnd1; ++iter1)
-      {
-          const art::Ptr<recob::PFParticle> recoParticle = iter1->first;
-          if (vetoReco.count(recoParticle) > 0)
-              continue;
-  
-          const lar_pandora::HitVector &hitVector = iter1->second;
-  
-          lar_pandora::MCParticlesToHits truthContributionMap;
-  
-          // Loop over all the hits associated to this reco particle
-          for (lar_pandora::HitVector::const_iterator iter2 = hitVector.begin(), iterEnd2 = hitVector.end(); iter2 != iterEnd2; ++iter2)
-          {
-              const art::Ptr<recob::Hit> hit = *iter2;
-  
-              lar_pandora::HitsToMCParticles::const_iterator iter3 = trueHitsToParticles.find(hit);
-              if (trueHitsToParticles.end() == iter3)
-                  continue;
-  
-              const art::Ptr<simb::MCParticle> trueParticle = iter3->second;
-              if (vetoTrue.count(trueParticle) > 0)
-                  continue;
-  
-              // This map will contain all the true particles that match some or all of the hits of the reco particle
-              truthContributionMap[trueParticle].push_back(hit);
-          }
-  
-          // Now we want to find the true particle that has more hits in common with this reco particle than the others
-          lar_pandora::MCParticlesToHits::const_iterator mIter = truthContributionMap.end();
-  
-          for (lar_pandora::MCParticlesToHits::const_iterator iter4 = truthContributionMap.begin(), iterEnd4 = truthContributionMap.end();
-              iter4 != iterEnd4; ++iter4)
-          {
-              if ((truthContributionMap.end() == mIter) || (iter4->second.size() > mIter->second.size()))
-              {
-                  mIter = iter4;
-              }
-          }
-  
-          if (truthContributionMap.end() != mIter)
-          {
-              const art::Ptr<simb::MCParticle> trueParticle = mIter->first;
-  
-              lar_pandora::MCParticlesToHits::const_iterator iter5 = matchedHits.find(trueParticle);
-  
-              if ((matchedHits.end() == iter5) || (mIter->second.size() > iter5->second.size()))
-              {
-                  matchedParticles[trueParticle] = recoParticle;
-                  matchedHits[trueParticle] = mIter->second;
-                  foundMatches = true;
-              }
-          }
-      } // recoParticlesToHits loop ends
-  
-      if (!foundMatches)
-          return;
-  
-      for (lar_pandora::MCParticlesToPFParticles::const_iterator pIter = matchedParticles.begin(), pIterEnd = matchedParticles.end();
-          pIter != pIterEnd; ++pIter)
-      {
-          vetoTrue.insert(pIter->first);
-          vetoReco.insert(pIter->second);
-      }
-  
-      if (_recursiveMatching)
-          GetRecoToTrueMatches(recoParticlesToHits, trueHitsToParticles, matchedParticles, matchedHits, vetoReco, vetoTrue, _recursiveMatching);
+      RecoTrueMatcher matcher;
+      matcher.Configure(recoParticlesToHits, trueHitsToParticles);
+      matcher.Match(matchedParticles, matchedHits, vetoReco, vetoTrue, _recursiveMatching);
   }
   
 } // namespace
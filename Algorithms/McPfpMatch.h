@@ -26,6 +26,9 @@
 #include "lardataobj/RecoBase/PFParticle.h"
 #include "larpandora/LArPandoraInterface/LArPandoraHelper.h"
 
+#include "RecoTrueMatcher.h"
+#include "SimChannelBackTracker.h"
+
 typedef std::map< art::Ptr<recob::PFParticle>, unsigned int > RecoParticleToNMatchedHits;
 typedef std::map< art::Ptr<simb::MCParticle>,  RecoParticleToNMatchedHits > ParticleMatchingMap;
 typedef std::set< art::Ptr<recob::PFParticle> > PFParticleSet;
@@ -45,18 +48,28 @@ namespace ubxsec {
   
     /// Configure function parameters
     void Configure(art::Event const & e, std::string _pfp_producer, std::string _spacepointLabel, std::string _hitfinderLabel, std::string _geantModuleLabel);
+
+    /// Same as above, the true hits are backtracked from the SimChannel index instead of the BackTracker service
+    void Configure(art::Event const & e, std::string _pfp_producer, std::string _spacepointLabel, std::string _hitfinderLabel, std::string _geantModuleLabel, SimChannelBackTracker const & simch_bt);
   
      /**
      *  @brief Returns matching between true and reconstructed particles
      *
      *  @param matchedParticles the output matches between reconstructed and true particles
      *  @param matchedHits the output matches between reconstructed particles and hits
+     *  @param recursiveMatching if true, repeats the matching on the particles not yet matched
      */  
-    void GetRecoToTrueMatches(lar_pandora::MCParticlesToPFParticles &matchedParticles, lar_pandora::MCParticlesToHits &matchedHits);
+    void GetRecoToTrueMatches(lar_pandora::MCParticlesToPFParticles &matchedParticles, lar_pandora::MCParticlesToHits &matchedHits, bool recursiveMatching = false);
+
+    /// Returns the matcher, to get the number of hits of the reco and true particles
+    const RecoTrueMatcher & GetMatcher() const { return _matcher; }
   
 
   protected:
 
+    /// Configures the matcher, backtracking from simch_bt if not null, from the BackTracker otherwise
+    void Configure(art::Event const & e, std::string _pfp_producer, std::string _spacepointLabel, std::string _hitfinderLabel, std::string _geantModuleLabel, SimChannelBackTracker const * simch_bt);
+
     /**
      *  @brief Perform matching between true and reconstructed particles
      *
@@ -79,8 +92,7 @@ namespace ubxsec {
      */
     void GetRecoToTrueMatches(const lar_pandora::PFParticlesToHits &recoParticlesToHits, const lar_pandora::HitsToMCParticles &trueHitsToParticles, lar_pandora::MCParticlesToPFParticles &matchedParticles, lar_pandora::MCParticlesToHits &matchedHits, PFParticleSet &recoVeto, MCParticleSet &trueVeto, bool _recursiveMatching);
 
-    lar_pandora::HitsToMCParticles _trueHitsToParticles; ///< A map from recon hits to MCParticles
-    lar_pandora::PFParticlesToHits _recoParticlesToHits; ///< A map from PFParticles to recon hits
+    RecoTrueMatcher _matcher; ///< Reco to true matching, indexed on the hits of the event
 
   };
 
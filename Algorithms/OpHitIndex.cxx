@@ -0,0 +1,96 @@
+#ifndef OPHITINDEX_CXX
+#define OPHITINDEX_CXX
+
+#include "OpHitIndex.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace ubxsec {
+
+  void OpHitIndex::Clear()
+  {
+    _opch_first.clear();
+    _time.clear();
+    _pe_sum.clear();
+  }
+
+  //___________________________________________________________________________________________________
+  void OpHitIndex::Fill(std::vector<recob::OpHit> const & ophit_v, std::vector<double> const & pe_v)
+  {
+    Clear();
+
+    if (ophit_v.size() != pe_v.size()) {
+      std::cout << "[OpHitIndex] Got " << ophit_v.size() << " OpHits and " << pe_v.size() << " PE values." << std::endl;
+      return;
+    }
+
+    int max_opch = -1;
+    for (auto const & ophit : ophit_v) max_opch = std::max(max_opch, ophit.OpChannel());
+    size_t n_opch = max_opch + 1;
+
+    // Order the OpHits by channel, then by time
+    std::vector<size_t> order(ophit_v.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&ophit_v](size_t a, size_t b) {
+      if (ophit_v[a].OpChannel() != ophit_v[b].OpChannel()) return ophit_v[a].OpChannel() < ophit_v[b].OpChannel();
+      return ophit_v[a].PeakTime() < ophit_v[b].PeakTime();
+    });
+
+    _opch_first.assign(n_opch + 1, 0);
+    for (auto const & ophit : ophit_v) {
+      if (ophit.OpChannel() >= 0) _opch_first[ophit.OpChannel() + 1]++;
+    }
+    std::partial_sum(_opch_first.begin(), _opch_first.end(), _opch_first.begin());
+
+    // Skip OpHits with a negative channel, they are at the front
+    size_t first = ophit_v.size() - _opch_first[n_opch];
+
+    _time.resize(_opch_first[n_opch]);
+    _pe_sum.assign(_opch_first[n_opch] + n_opch, 0.);
+
+    for (size_t opch = 0; opch < n_opch; opch++) {
+      double sum = 0.;
+      for (size_t i = _opch_first[opch]; i < _opch_first[opch+1]; i++) {
+        size_t oh = order[first + i];
+        _time[i] = ophit_v[oh].PeakTime();
+        sum += pe_v[oh];
+        _pe_sum[i + opch + 1] = sum;
+      }
+    }
+  }
+
+  //___________________________________________________________________________________________________
+  bool OpHitIndex::Range(int opch, double t_start, double t_end, size_t & first, size_t & last) const
+  {
+    if (opch < 0 || (size_t)opch + 1 >= _opch_first.size()) return false;
+
+    auto begin = _time.begin() + _opch_first[opch];
+    auto end   = _time.begin() + _opch_first[opch+1];
+
+    first = std::upper_bound(begin, end, t_start) - _time.begin();
+    last  = std::lower_bound(begin, end, t_end) - _time.begin();
+
+    return first < last;
+  }
+
+  //___________________________________________________________________________________________________
+  int OpHitIndex::NOpHits(int opch, double t_start, double t_end) const
+  {
+    size_t first, last;
+    if (!Range(opch, t_start, t_end, first, last)) return 0;
+
+    return last - first;
+  }
+
+  //___________________________________________________________________________________________________
+  double OpHitIndex::PE(int opch, double t_start, double t_end) const
+  {
+    size_t first, last;
+    if (!Range(opch, t_start, t_end, first, last)) return 0.;
+
+    return _pe_sum[last + opch] - _pe_sum[first + opch];
+  }
+}
+
+#endif
@@ -0,0 +1,82 @@
+/**
+ * \file OpHitIndex.h
+ *
+ * \ingroup UBXSec
+ *
+ * \brief Per-event OpHits grouped by OpChannel and sorted in time, with calibrated PE sums
+ *
+ * @author Marco Del Tutto
+ */
+
+/** \addtogroup UBXSec
+
+    @{*/
+
+#ifndef OPHITINDEX_H
+#define OPHITINDEX_H
+
+#include <iostream>
+#include <vector>
+
+#include "lardataobj/RecoBase/OpHit.h"
+
+namespace ubxsec {
+
+  /**
+   * \class OpHitIndex
+   *
+   * Stores the peak times of the OpHits of an event grouped by OpChannel
+   * and sorted in time within each channel, together with a running sum
+   * of the calibrated PE. The number of OpHits and the PE of a channel in
+   * a time window are then two binary searches, for any window.
+   *
+   * Channel c uses the times [_opch_first[c], _opch_first[c+1]) and the
+   * PE sums [_opch_first[c]+c, _opch_first[c+1]+c], the first sum of a
+   * channel being 0. The PE are passed already calibrated, so that the
+   * index does not depend on the calibration.
+   */
+  class OpHitIndex {
+
+  public:
+
+    /// Default constructor
+    OpHitIndex() = default;
+
+    /// Default destructor
+    ~OpHitIndex(){}
+
+    /**
+     *  @brief Fills the index
+     *
+     *  @param ophit_v the OpHits
+     *  @param pe_v the calibrated PE of each OpHit (same size as ophit_v)
+     *
+     *  OpHits with a negative OpChannel are not indexed.
+     */
+    void Fill(std::vector<recob::OpHit> const & ophit_v, std::vector<double> const & pe_v);
+
+    /// Empties the index
+    void Clear();
+
+    /// Returns the number of OpHits in the index
+    size_t size() const { return _time.size(); }
+
+    /// Returns the number of OpHits on an OpChannel with t_start < peak time < t_end
+    int NOpHits(int opch, double t_start, double t_end) const;
+
+    /// Returns the PE on an OpChannel from OpHits with t_start < peak time < t_end
+    double PE(int opch, double t_start, double t_end) const;
+
+  private:
+
+    /// Sets first and last to the range of OpHits on opch with t_start < peak time < t_end, returns false if empty
+    bool Range(int opch, double t_start, double t_end, size_t & first, size_t & last) const;
+
+    std::vector<size_t> _opch_first;  ///< Index of the first OpHit of each OpChannel (one more entry at the end)
+    std::vector<double> _time;        ///< OpHit peak times, grouped by OpChannel and sorted
+    std::vector<double> _pe_sum;      ///< Running PE sum per OpChannel, see the class description
+  };
+}
+
+#endif //  OPHITINDEX_H
+/** @} */ // end of doxygen group
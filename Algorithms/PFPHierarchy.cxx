@@ -0,0 +1,83 @@
+#ifndef PFPHIERARCHY_CXX
+#define PFPHIERARCHY_CXX
+
+#include "PFPHierarchy.h"
+
+#include <algorithm>
+
+namespace ubxsec {
+
+  const size_t PFPHierarchy::kInvalidIndex;
+
+  PFPHierarchy::PFPHierarchy(lar_pandora::PFParticleVector const & pfp_v)
+  {
+    Build(pfp_v);
+  }
+
+  //___________________________________________________________________________________________________
+  void PFPHierarchy::Build(lar_pandora::PFParticleVector const & pfp_v)
+  {
+    _pfp_v = pfp_v;
+
+    size_t n = _pfp_v.size();
+
+    // Self() -> index table
+    size_t max_self = 0;
+    for (auto const & pfp : _pfp_v) max_self = std::max(max_self, pfp->Self());
+
+    _self_to_index.assign(n == 0 ? 0 : max_self + 1, kInvalidIndex);
+    for (size_t i = 0; i < n; i++) _self_to_index[_pfp_v[i]->Self()] = i;
+
+    // Daughters of each PFP, stored contiguously
+    size_t n_daughters = 0;
+    for (auto const & pfp : _pfp_v) n_daughters += pfp->NumDaughters();
+
+    _offsets.assign(n + 1, 0);
+    _children.clear();
+    _children.reserve(n_daughters);
+
+    for (size_t i = 0; i < n; i++) {
+
+      _offsets[i] = _children.size();
+
+      for (size_t daughter_self : _pfp_v[i]->Daughters()) {
+
+        size_t index = IndexFromSelf(daughter_self);
+        if (index == kInvalidIndex) {
+          std::cout << "[PFPHierarchy] Daughter " << daughter_self << " of PFP " << _pfp_v[i]->Self()
+                    << " is not in the PFP list, skipping it." << std::endl;
+          continue;
+        }
+        _children.push_back(index);
+      }
+    }
+    _offsets[n] = _children.size();
+
+    _stack.reserve(n);
+    _visited.reserve(n);
+  }
+
+  //___________________________________________________________________________________________________
+  void PFPHierarchy::CollectHierarchy(size_t root, std::vector<size_t> & out) const
+  {
+    if (root >= _pfp_v.size()) return;
+
+    _stack.clear();
+    _stack.push_back(root);
+
+    while (!_stack.empty()) {
+
+      size_t index = _stack.back();
+      _stack.pop_back();
+
+      out.push_back(index);
+
+      // Push the daughters in reverse order, so that they are visited in the original order
+      for (size_t const * d = DaughtersEnd(index); d != DaughtersBegin(index); ) {
+        _stack.push_back(*(--d));
+      }
+    }
+  }
+}
+
+#endif
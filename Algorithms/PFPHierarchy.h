@@ -0,0 +1,133 @@
+/**
+ * \file PFPHierarchy.h
+ *
+ * \ingroup UBXSec
+ *
+ * \brief Flat (CSR) representation of the PFParticle hierarchy
+ *
+ * @author Marco Del Tutto
+ */
+
+/** \addtogroup UBXSec
+
+    @{*/
+
+#ifndef PFPHIERARCHY_H
+#define PFPHIERARCHY_H
+
+#include <iostream>
+#include <vector>
+#include <limits>
+
+#include "lardataobj/RecoBase/PFParticle.h"
+#include "larpandora/LArPandoraInterface/LArPandoraHelper.h"
+
+namespace ubxsec {
+
+  /**
+   * \class PFPHierarchy
+   *
+   * Stores, for a list of PFParticles, the daughters of each PFP as
+   * indices in the list (offsets + children, CSR layout), together with a
+   * table from PFParticle::Self() to the index in the list. Build it once
+   * per event; slices are then collected with an iterative depth-first
+   * traversal that visits the PFPs in the same order as the recursive
+   * one (mother first, then each daughter with all its descendants).
+   *
+   * Collect functions reuse an internal stack, so the same object should
+   * not be traversed by more than one thread at a time.
+   */
+  class PFPHierarchy {
+
+  public:
+
+    static const size_t kInvalidIndex = std::numeric_limits<size_t>::max();
+
+    /// Default constructor
+    PFPHierarchy() = default;
+
+    /// Constructor, builds the hierarchy from the PFP list
+    explicit PFPHierarchy(lar_pandora::PFParticleVector const & pfp_v);
+
+    /// Default destructor
+    ~PFPHierarchy(){}
+
+    /// Builds the hierarchy from the PFP list, replacing the current content
+    void Build(lar_pandora::PFParticleVector const & pfp_v);
+
+    /// Returns the number of PFPs
+    size_t size() const { return _pfp_v.size(); }
+
+    /// Returns the PFP at index in the list
+    art::Ptr<recob::PFParticle> const & GetPFP(size_t index) const { return _pfp_v[index]; }
+
+    /// Returns the index in the list of the PFP with PFParticle::Self() == self, kInvalidIndex if not there
+    size_t IndexFromSelf(size_t self) const { return (self < _self_to_index.size() ? _self_to_index[self] : kInvalidIndex); }
+
+    /// Returns the index in the list of the PFP passed, kInvalidIndex if not there
+    size_t Index(art::Ptr<recob::PFParticle> const & pfp) const { return IndexFromSelf(pfp->Self()); }
+
+    /// Returns the number of daughters of the PFP at index
+    size_t NumDaughters(size_t index) const { return _offsets[index + 1] - _offsets[index]; }
+
+    /// Returns a pointer to the first daughter index of the PFP at index
+    size_t const * DaughtersBegin(size_t index) const { return _children.data() + _offsets[index]; }
+
+    /// Returns a pointer past the last daughter index of the PFP at index
+    size_t const * DaughtersEnd(size_t index) const { return _children.data() + _offsets[index + 1]; }
+
+    /**
+     *  @brief Collects the indices of the PFPs in the hierarchy starting at root (root included), depth first
+     *
+     *  @param root the index of the top PFP
+     *  @param out output, the PFP indices (appended) */
+    void CollectHierarchy(size_t root, std::vector<size_t> & out) const;
+
+    /**
+     *  @brief Collects the PFPs in the hierarchy starting at root and the objects (tracks, showers, ...) associated to them
+     *
+     *  @param root the index of the top PFP
+     *  @param pfp_to_obj map from PFP to the associated objects
+     *  @param pfp_v output, the PFPs (appended)
+     *  @param obj_v output, the associated objects (appended) */
+    template <typename PFPToObjMap, typename ObjVector>
+    void CollectPFPAndObjects(size_t root, PFPToObjMap const & pfp_to_obj, lar_pandora::PFParticleVector & pfp_v, ObjVector & obj_v) const;
+
+  private:
+
+    lar_pandora::PFParticleVector _pfp_v;   ///< The PFP list
+    std::vector<size_t> _offsets;           ///< Daughters of PFP i are _children[_offsets[i]] ... _children[_offsets[i+1]-1]
+    std::vector<size_t> _children;          ///< Daughter indices
+    std::vector<size_t> _self_to_index;     ///< PFParticle::Self() -> index in the list
+
+    mutable std::vector<size_t> _stack;     ///< Traversal stack, reused between calls
+    mutable std::vector<size_t> _visited;   ///< Traversal output, reused between calls
+  };
+
+  //___________________________________________________________________________________________________
+  template <typename PFPToObjMap, typename ObjVector>
+  void PFPHierarchy::CollectPFPAndObjects(size_t root,
+                                          PFPToObjMap const & pfp_to_obj,
+                                          lar_pandora::PFParticleVector & pfp_v,
+                                          ObjVector & obj_v) const
+  {
+    _visited.clear();
+    CollectHierarchy(root, _visited);
+
+    pfp_v.reserve(pfp_v.size() + _visited.size());
+
+    for (size_t index : _visited) {
+
+      art::Ptr<recob::PFParticle> const & pfp = _pfp_v[index];
+      pfp_v.emplace_back(pfp);
+
+      auto iter = pfp_to_obj.find(pfp);
+      if (iter == pfp_to_obj.end()) continue;
+
+      obj_v.insert(obj_v.end(), iter->second.begin(), iter->second.end());
+    }
+  }
+}
+
+#endif //  PFPHIERARCHY_H
+/** @} */ // end of doxygen group
@@ -0,0 +1,125 @@
+#ifndef PMTTABLE_CXX
+#define PMTTABLE_CXX
+
+#include "PMTTable.h"
+
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ubxsec {
+
+  PMTTable::PMTTable(geo::Geometry const & geo)
+  {
+    size_t n = geo.NOpDets();
+
+    _x.resize(n);
+    _y.resize(n);
+    _z.resize(n);
+    _opch_to_opdet.resize(n);
+    _opdet_to_opch.assign(n, 0);
+
+    for (size_t opch = 0; opch < n; opch++) {
+
+      double xyz[3];
+      geo.OpDetGeoFromOpChannel(opch).GetCenter(xyz);
+      _x[opch] = xyz[0];
+      _y[opch] = xyz[1];
+      _z[opch] = xyz[2];
+
+      size_t opdet = geo.OpDetFromOpChannel(opch);
+      _opch_to_opdet[opch] = opdet;
+      if (opdet < n) _opdet_to_opch[opdet] = opch;
+    }
+  }
+
+  //___________________________________________________________________________________________________
+  PMTTable const & PMTTable::Instance()
+  {
+    static const PMTTable table(*(art::ServiceHandle<geo::Geometry>()));
+    return table;
+  }
+
+  //___________________________________________________________________________________________________
+  int PMTTable::ClosestOpChannel(double const * xyz) const
+  {
+    int pmt_id = -1;
+    double min_dist2 = 1.e18;
+
+    for (size_t opch = 0; opch < _x.size(); opch++) {
+
+      double dx = xyz[0] - _x[opch];
+      double dy = xyz[1] - _y[opch];
+      double dz = xyz[2] - _z[opch];
+      double dist2 = dx*dx + dy*dy + dz*dz;
+
+      if (dist2 < min_dist2) {
+        min_dist2 = dist2;
+        pmt_id = opch;
+      }
+    }
+
+    return pmt_id;
+  }
+
+  //___________________________________________________________________________________________________
+  void PMTTable::FlashLocation(std::vector<double> const & pe_per_opch,
+                               double & Ycenter,
+                               double & Zcenter,
+                               double & Ywidth,
+                               double & Zwidth) const
+  {
+    // Reset variables
+    Ycenter = Zcenter = 0.;
+    Ywidth  = Zwidth  = -999.;
+    double totalPE = 0.;
+    double sumy = 0., sumz = 0., sumy2 = 0., sumz2 = 0.;
+
+    size_t n = std::min(pe_per_opch.size(), _x.size());
+    double const * pe = pe_per_opch.data();
+    double const * y  = _y.data();
+    double const * z  = _z.data();
+
+    for (size_t opch = 0; opch < n; opch++) {
+
+      // Add up the position, weighting with PEs
+      sumy    += pe[opch]*y[opch];
+      sumy2   += pe[opch]*y[opch]*y[opch];
+      sumz    += pe[opch]*z[opch];
+      sumz2   += pe[opch]*z[opch]*z[opch];
+
+      totalPE += pe[opch];
+    }
+
+    Ycenter = sumy/totalPE;
+    Zcenter = sumz/totalPE;
+
+    // This is just sqrt(<x^2> - <x>^2)
+    if ( (sumy2*totalPE - sumy*sumy) > 0. )
+      Ywidth = std::sqrt(sumy2*totalPE - sumy*sumy)/totalPE;
+
+    if ( (sumz2*totalPE - sumz*sumz) > 0. )
+      Zwidth = std::sqrt(sumz2*totalPE - sumz*sumz)/totalPE;
+  }
+
+  //___________________________________________________________________________________________________
+  double PMTTable::FlashZCenterFromOpDet(std::vector<double> const & pe_per_opdet) const
+  {
+    double totalPE = 0.;
+    double sumz = 0.;
+
+    size_t n = std::min(pe_per_opdet.size(), _opdet_to_opch.size());
+
+    for (size_t opdet = 0; opdet < n; opdet++) {
+
+      // Add up the position, weighting with PEs
+      sumz    += pe_per_opdet[opdet]*_z[_opdet_to_opch[opdet]];
+      totalPE += pe_per_opdet[opdet];
+    }
+
+    return sumz/totalPE;
+  }
+}
+
+#endif
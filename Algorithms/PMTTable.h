@@ -0,0 +1,97 @@
+/**
+ * \file PMTTable.h
+ *
+ * \ingroup UBXSec
+ *
+ * \brief Cached PMT positions and OpChannel <-> OpDet maps
+ *
+ * @author Marco Del Tutto
+ */
+
+/** \addtogroup UBXSec
+
+    @{*/
+
+#ifndef PMTTABLE_H
+#define PMTTABLE_H
+
+#include <iostream>
+#include <vector>
+
+#include "larcore/Geometry/Geometry.h"
+
+namespace ubxsec {
+
+  /**
+   * \class PMTTable
+   *
+   * Reads the PMT centers and the OpChannel <-> OpDet maps from the
+   * geometry once, and stores the positions as separate x, y, z arrays
+   * indexed by OpChannel. The table does not change after it is built.
+   * Instance() returns a table shared by all the modules, built the first
+   * time it is used.
+   *
+   * The positions are those of OpDetGeoFromOpChannel, for the OpChannels
+   * 0 ... NOpDets()-1.
+   */
+  class PMTTable {
+
+  public:
+
+    /// Builds the table from the geometry
+    explicit PMTTable(geo::Geometry const & geo);
+
+    /// Default destructor
+    ~PMTTable(){}
+
+    /// Returns the table built from the geometry service, shared by everybody
+    static PMTTable const & Instance();
+
+    /// Returns the number of PMTs
+    size_t size() const { return _x.size(); }
+
+    /// Returns the OpDet of an OpChannel
+    size_t OpChannelToOpDet(size_t opch) const { return _opch_to_opdet[opch]; }
+
+    /// Returns the OpChannel of an OpDet
+    size_t OpDetToOpChannel(size_t opdet) const { return _opdet_to_opch[opdet]; }
+
+    /// Returns the x, y and z position of the PMT center for an OpChannel
+    double X(size_t opch) const { return _x[opch]; }
+    double Y(size_t opch) const { return _y[opch]; }
+    double Z(size_t opch) const { return _z[opch]; }
+
+    /**
+     *  @brief Returns the OpChannel of the PMT closest to a point, -1 if there are no PMTs
+     *
+     *  @param xyz the 3D point (c array) */
+    int ClosestOpChannel(double const * xyz) const;
+
+    /**
+     *  @brief Returns the PE weighted center and width of a flash, in y and z
+     *
+     *  @param pe_per_opch the PEs per OpChannel
+     *  @param Ycenter output, the y center
+     *  @param Zcenter output, the z center
+     *  @param Ywidth output, the y width (-999 if not defined)
+     *  @param Zwidth output, the z width (-999 if not defined) */
+    void FlashLocation(std::vector<double> const & pe_per_opch, double & Ycenter, double & Zcenter, double & Ywidth, double & Zwidth) const;
+
+    /**
+     *  @brief Returns the PE weighted z center of a flash
+     *
+     *  @param pe_per_opdet the PEs per OpDet */
+    double FlashZCenterFromOpDet(std::vector<double> const & pe_per_opdet) const;
+
+  private:
+
+    std::vector<double> _x;              ///< PMT center x, per OpChannel
+    std::vector<double> _y;              ///< PMT center y, per OpChannel
+    std::vector<double> _z;              ///< PMT center z, per OpChannel
+    std::vector<size_t> _opch_to_opdet;  ///< OpChannel -> OpDet
+    std::vector<size_t> _opdet_to_opch;  ///< OpDet -> OpChannel
+  };
+}
+
+#endif //  PMTTABLE_H
+/** @} */ // end of doxygen group
@@ -0,0 +1,94 @@
+#ifndef PANDORAEVENTCACHE_CXX
+#define PANDORAEVENTCACHE_CXX
+
+#include "PandoraEventCache.h"
+
+namespace ubxsec {
+
+  PandoraEventCache::PandoraEventCache(art::Event const & e, std::string pfp_producer)
+  {
+    Fill(e, pfp_producer, pfp_producer, pfp_producer);
+  }
+
+  //___________________________________________________________________________________________________
+  PandoraEventCache::PandoraEventCache(art::Event const & e, std::string pfp_producer, std::string track_producer, std::string shower_producer)
+  {
+    Fill(e, pfp_producer, track_producer, shower_producer);
+  }
+
+  //___________________________________________________________________________________________________
+  void PandoraEventCache::Fill(art::Event const & e, std::string pfp_producer, std::string track_producer, std::string shower_producer)
+  {
+    _pfp_v.clear();              _pfp_to_clusters.clear();
+    _vertex_v.clear();           _pfp_to_vertices.clear();
+    _track_v.clear();            _pfp_to_tracks.clear();   _tracks_to_hits.clear();
+    _shower_v.clear();           _pfp_to_showers.clear();  _showers_to_hits.clear();
+    _pfp_to_spacepoints.clear(); _spacepoint_v.clear();    _spacepoints_to_hits.clear();
+
+    lar_pandora::LArPandoraHelper::CollectPFParticles(e, pfp_producer, _pfp_v, _pfp_to_clusters);
+    _pfp_hierarchy.Build(_pfp_v);
+    lar_pandora::LArPandoraHelper::CollectVertices(e, pfp_producer, _vertex_v, _pfp_to_vertices);
+
+    lar_pandora::LArPandoraHelper::CollectTracks(e, track_producer, _track_v, _pfp_to_tracks);
+    lar_pandora::TrackVector temp_track_v;
+    lar_pandora::LArPandoraHelper::CollectTracks(e, track_producer, temp_track_v, _tracks_to_hits);
+
+    lar_pandora::LArPandoraHelper::CollectShowers(e, shower_producer, _shower_v, _pfp_to_showers);
+    lar_pandora::ShowerVector temp_shower_v;
+    lar_pandora::LArPandoraHelper::CollectShowers(e, shower_producer, temp_shower_v, _showers_to_hits);
+
+    lar_pandora::PFParticleVector temp_pfp_v;
+    lar_pandora::LArPandoraHelper::CollectPFParticles(e, pfp_producer, temp_pfp_v, _pfp_to_spacepoints);
+    lar_pandora::LArPandoraHelper::CollectSpacePoints(e, pfp_producer, _spacepoint_v, _spacepoints_to_hits);
+
+    _track_hit_counts.Fill(_tracks_to_hits);
+    _shower_hit_counts.Fill(_showers_to_hits);
+    _track_summaries.Fill(_track_v);
+    _pfp_charge_moments.Fill(_pfp_to_spacepoints, _spacepoints_to_hits);
+
+    _event_id = e.id();
+    _is_filled = true;
+  }
+
+  //___________________________________________________________________________________________________
+  lar_pandora::VertexVector const & PandoraEventCache::GetVertices(art::Ptr<recob::PFParticle> const & pfp) const
+  {
+    auto it = _pfp_to_vertices.find(pfp);
+    if (it == _pfp_to_vertices.end()) return _empty_vertex_v;
+    return it->second;
+  }
+
+  //___________________________________________________________________________________________________
+  lar_pandora::TrackVector const & PandoraEventCache::GetTracks(art::Ptr<recob::PFParticle> const & pfp) const
+  {
+    auto it = _pfp_to_tracks.find(pfp);
+    if (it == _pfp_to_tracks.end()) return _empty_track_v;
+    return it->second;
+  }
+
+  //___________________________________________________________________________________________________
+  lar_pandora::ShowerVector const & PandoraEventCache::GetShowers(art::Ptr<recob::PFParticle> const & pfp) const
+  {
+    auto it = _pfp_to_showers.find(pfp);
+    if (it == _pfp_to_showers.end()) return _empty_shower_v;
+    return it->second;
+  }
+
+  //___________________________________________________________________________________________________
+  lar_pandora::HitVector const & PandoraEventCache::GetHits(art::Ptr<recob::Track> const & trk) const
+  {
+    auto it = _tracks_to_hits.find(trk);
+    if (it == _tracks_to_hits.end()) return _empty_hit_v;
+    return it->second;
+  }
+
+  //___________________________________________________________________________________________________
+  lar_pandora::HitVector const & PandoraEventCache::GetHits(art::Ptr<recob::Shower> const & shwr) const
+  {
+    auto it = _showers_to_hits.find(shwr);
+    if (it == _showers_to_hits.end()) return _empty_hit_v;
+    return it->second;
+  }
+}
+
+#endif
@@ -0,0 +1,141 @@
+/**
+ * \file PandoraEventCache.h
+ *
+ * \ingroup UBXSec
+ *
+ * \brief Event-scoped cache of the Pandora products and associations
+ *
+ * @author Marco Del Tutto
+ */
+
+/** \addtogroup UBXSec
+
+    @{*/
+
+#ifndef PANDORAEVENTCACHE_H
+#define PANDORAEVENTCACHE_H
+
+#include <iostream>
+#include <string>
+
+#include "art/Framework/Principal/Event.h"
+#include "lardataobj/RecoBase/PFParticle.h"
+#include "larpandora/LArPandoraInterface/LArPandoraHelper.h"
+
+#include "HitCountTable.h"
+#include "TrackSummaryTable.h"
+#include "ChargeMomentTable.h"
+#include "PFPHierarchy.h"
+
+namespace ubxsec {
+
+  /**
+   * \class PandoraEventCache
+   *
+   * Collects, once per event, the PFParticles and all the associations
+   * the UBXSecHelper functions need (vertices, tracks, showers, spacepoints
+   * and their hits). Build one per event and pass it to the helpers instead
+   * of the art::Event, so the event-wide maps are not rebuilt for every
+   * slice or track.
+   */
+  class PandoraEventCache {
+
+  public:
+
+    /// Default constructor, the cache is empty until Fill is called
+    PandoraEventCache() = default;
+
+    /// Constructor, fills the cache using the same producer for PFParticles, tracks and showers
+    PandoraEventCache(art::Event const & e, std::string pfp_producer);
+
+    /// Constructor, fills the cache using different track and shower producers
+    PandoraEventCache(art::Event const & e, std::string pfp_producer, std::string track_producer, std::string shower_producer);
+
+    /// Default destructor
+    ~PandoraEventCache(){}
+
+    /// Collects all the Pandora products for this event, replacing the current content
+    void Fill(art::Event const & e, std::string pfp_producer, std::string track_producer, std::string shower_producer);
+
+    /// Returns true if the cache was filled for the event passed
+    bool IsFilledFor(art::Event const & e) const { return _is_filled && e.id() == _event_id; }
+
+    lar_pandora::PFParticleVector const & GetPFParticles() const { return _pfp_v; }
+    lar_pandora::PFParticlesToClusters const & GetPFParticlesToClusters() const { return _pfp_to_clusters; }
+    lar_pandora::PFParticlesToVertices const & GetPFParticlesToVertices() const { return _pfp_to_vertices; }
+    lar_pandora::PFParticlesToTracks const & GetPFParticlesToTracks() const { return _pfp_to_tracks; }
+    lar_pandora::PFParticlesToShowers const & GetPFParticlesToShowers() const { return _pfp_to_showers; }
+    lar_pandora::PFParticlesToSpacePoints const & GetPFParticlesToSpacePoints() const { return _pfp_to_spacepoints; }
+
+    lar_pandora::VertexVector const & GetVertices() const { return _vertex_v; }
+    lar_pandora::TrackVector const & GetTracks() const { return _track_v; }
+    lar_pandora::ShowerVector const & GetShowers() const { return _shower_v; }
+    lar_pandora::SpacePointVector const & GetSpacePoints() const { return _spacepoint_v; }
+
+    lar_pandora::TracksToHits const & GetTracksToHits() const { return _tracks_to_hits; }
+    lar_pandora::ShowersToHits const & GetShowersToHits() const { return _showers_to_hits; }
+    lar_pandora::SpacePointsToHits const & GetSpacePointsToHits() const { return _spacepoints_to_hits; }
+
+    /// Returns the PFP hierarchy (daughters and Self() -> index table)
+    PFPHierarchy const & GetPFPHierarchy() const { return _pfp_hierarchy; }
+
+    /// Returns the per-plane hit counts of all the tracks, indexed by track key
+    HitCountTable const & GetTrackHitCounts() const { return _track_hit_counts; }
+
+    /// Returns the per-plane hit counts of all the showers, indexed by shower key
+    HitCountTable const & GetShowerHitCounts() const { return _shower_hit_counts; }
+
+    /// Returns the length, end points and directions of all the tracks, indexed by track key
+    TrackSummaryTable const & GetTrackSummaries() const { return _track_summaries; }
+
+    /// Returns the charge moments of the spacepoints of all the PFPs, indexed by PFP key
+    ChargeMomentTable const & GetPFPChargeMoments() const { return _pfp_charge_moments; }
+
+    /// Returns the vertices associated to a PFP (empty if none)
+    lar_pandora::VertexVector const & GetVertices(art::Ptr<recob::PFParticle> const & pfp) const;
+
+    /// Returns the tracks associated to a PFP (empty if none)
+    lar_pandora::TrackVector const & GetTracks(art::Ptr<recob::PFParticle> const & pfp) const;
+
+    /// Returns the showers associated to a PFP (empty if none)
+    lar_pandora::ShowerVector const & GetShowers(art::Ptr<recob::PFParticle> const & pfp) const;
+
+    /// Returns the hits associated to a track (empty if none)
+    lar_pandora::HitVector const & GetHits(art::Ptr<recob::Track> const & trk) const;
+
+    /// Returns the hits associated to a shower (empty if none)
+    lar_pandora::HitVector const & GetHits(art::Ptr<recob::Shower> const & shwr) const;
+
+  private:
+
+    bool _is_filled = false;
+    art::EventID _event_id;
+
+    lar_pandora::PFParticleVector         _pfp_v;              ///< All the PFParticles in the event
+    lar_pandora::PFParticlesToClusters    _pfp_to_clusters;    ///< PFP -> clusters
+    PFPHierarchy                          _pfp_hierarchy;      ///< PFP daughters in CSR layout
+    lar_pandora::VertexVector             _vertex_v;           ///< All the PFP vertices
+    lar_pandora::PFParticlesToVertices    _pfp_to_vertices;    ///< PFP -> vertices
+    lar_pandora::TrackVector              _track_v;            ///< All the PFP tracks
+    lar_pandora::PFParticlesToTracks      _pfp_to_tracks;      ///< PFP -> tracks
+    lar_pandora::TracksToHits             _tracks_to_hits;     ///< Track -> hits
+    lar_pandora::ShowerVector             _shower_v;           ///< All the PFP showers
+    lar_pandora::PFParticlesToShowers     _pfp_to_showers;     ///< PFP -> showers
+    lar_pandora::ShowersToHits            _showers_to_hits;    ///< Shower -> hits
+    lar_pandora::PFParticlesToSpacePoints _pfp_to_spacepoints; ///< PFP -> spacepoints
+    lar_pandora::SpacePointVector         _spacepoint_v;       ///< All the spacepoints
+    lar_pandora::SpacePointsToHits        _spacepoints_to_hits;///< Spacepoint -> hit
+    HitCountTable                         _track_hit_counts;   ///< Track key -> hits per plane
+    HitCountTable                         _shower_hit_counts;  ///< Shower key -> hits per plane
+    TrackSummaryTable                     _track_summaries;    ///< Track key -> length, end points, directions
+    ChargeMomentTable                     _pfp_charge_moments; ///< PFP key -> spacepoint charge moments
+
+    const lar_pandora::VertexVector _empty_vertex_v = {};
+    const lar_pandora::TrackVector  _empty_track_v  = {};
+    const lar_pandora::ShowerVector _empty_shower_v = {};
+    const lar_pandora::HitVector    _empty_hit_v    = {};
+  };
+}
+
+#endif //  PANDORAEVENTCACHE_H
+/** @} */ // end of doxygen group
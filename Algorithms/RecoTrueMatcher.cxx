@@ -0,0 +1,286 @@
+#ifndef RECOTRUEMATCHER_CXX
+#define RECOTRUEMATCHER_CXX
+
+#include "RecoTrueMatcher.h"
+
+#include <algorithm>
+#include <queue>
+
+namespace ubxsec {
+
+  const int RecoTrueMatcher::kNoMatch;
+
+  void RecoTrueMatcher::Configure(const lar_pandora::PFParticlesToHits &recoParticlesToHits,
+                                  const lar_pandora::HitsToMCParticles &trueHitsToParticles)
+  {
+    // True particles, sorted so that the index order is the art::Ptr order
+    _true_v.clear();
+    _true_v.reserve(trueHitsToParticles.size());
+    for (auto const & iter : trueHitsToParticles) _true_v.push_back(iter.second);
+    std::sort(_true_v.begin(), _true_v.end());
+    _true_v.erase(std::unique(_true_v.begin(), _true_v.end()), _true_v.end());
+
+    _true_n_hits.assign(_true_v.size(), 0);
+
+    // Hit -> true particle index
+    _hit_tables.clear();
+    for (auto const & iter : trueHitsToParticles) {
+
+      art::Ptr<recob::Hit> const & hit = iter.first;
+
+      std::vector<int> * table = nullptr;
+      for (auto & t : _hit_tables) {
+        if (t.first == hit.id()) { table = &(t.second); break; }
+      }
+      if (table == nullptr) {
+        _hit_tables.emplace_back(hit.id(), std::vector<int>());
+        table = &(_hit_tables.back().second);
+      }
+
+      if (table->size() <= hit.key()) table->resize(hit.key() + 1, kNoMatch);
+      int t = TrueIndex(iter.second);
+      (*table)[hit.key()] = t;
+      _true_n_hits[t]++;
+    }
+
+    // Reco particles and their hits, flattened (the map is already in art::Ptr order)
+    size_t n_hits = 0;
+    for (auto const & iter : recoParticlesToHits) n_hits += iter.second.size();
+
+    _reco_v.clear();
+    _reco_offsets.assign(1, 0);
+    _reco_hit_v.clear();
+    _reco_hit_true.clear();
+
+    _reco_v.reserve(recoParticlesToHits.size());
+    _reco_offsets.reserve(recoParticlesToHits.size() + 1);
+    _reco_hit_v.reserve(n_hits);
+    _reco_hit_true.reserve(n_hits);
+
+    for (auto const & iter : recoParticlesToHits) {
+      _reco_v.push_back(iter.first);
+      for (auto const & hit : iter.second) {
+        _reco_hit_v.push_back(hit);
+        _reco_hit_true.push_back(HitToTrueIndex(hit));
+      }
+      _reco_offsets.push_back(_reco_hit_v.size());
+    }
+
+    BuildCandidates();
+  }
+
+  //___________________________________________________________________________________________________
+  int RecoTrueMatcher::HitToTrueIndex(art::Ptr<recob::Hit> const & hit) const
+  {
+    for (auto const & t : _hit_tables) {
+      if (!(t.first == hit.id())) continue;
+      if (hit.key() >= t.second.size()) return kNoMatch;
+      return t.second[hit.key()];
+    }
+    return kNoMatch;
+  }
+
+  //___________________________________________________________________________________________________
+  int RecoTrueMatcher::TrueIndex(art::Ptr<simb::MCParticle> const & part) const
+  {
+    auto it = std::lower_bound(_true_v.begin(), _true_v.end(), part);
+    if (it == _true_v.end() || !(*it == part)) return kNoMatch;
+    return it - _true_v.begin();
+  }
+
+  //___________________________________________________________________________________________________
+  int RecoTrueMatcher::RecoIndex(art::Ptr<recob::PFParticle> const & part) const
+  {
+    auto it = std::lower_bound(_reco_v.begin(), _reco_v.end(), part);
+    if (it == _reco_v.end() || !(*it == part)) return kNoMatch;
+    return it - _reco_v.begin();
+  }
+
+  //___________________________________________________________________________________________________
+  int RecoTrueMatcher::NRecoHits(art::Ptr<recob::PFParticle> const & part) const
+  {
+    int r = RecoIndex(part);
+    if (r == kNoMatch) return 0;
+    return _reco_offsets[r + 1] - _reco_offsets[r];
+  }
+
+  //___________________________________________________________________________________________________
+  int RecoTrueMatcher::NTrueHits(art::Ptr<simb::MCParticle> const & part) const
+  {
+    int t = TrueIndex(part);
+    if (t == kNoMatch) return 0;
+    return _true_n_hits[t];
+  }
+
+  //___________________________________________________________________________________________________
+  void RecoTrueMatcher::BuildCandidates()
+  {
+    size_t n_reco = _reco_v.size();
+
+    std::vector<int> counts(_true_v.size(), 0);
+    std::vector<int> touched;
+
+    _cand_offsets.assign(1, 0);
+    _cand_offsets.reserve(n_reco + 1);
+    _cand_v.clear();
+
+    for (size_t r = 0; r < n_reco; r++) {
+
+      touched.clear();
+      for (size_t h = _reco_offsets[r]; h < _reco_offsets[r + 1]; h++) {
+        int t = _reco_hit_true[h];
+        if (t == kNoMatch) continue;
+        if (counts[t]++ == 0) touched.push_back(t);
+      }
+
+      size_t begin = _cand_v.size();
+      for (int t : touched) {
+        _cand_v.emplace_back(t, counts[t]);
+        counts[t] = 0;
+      }
+
+      // Most shared hits first, ties go to the lowest index (first in art::Ptr order)
+      std::sort(_cand_v.begin() + begin, _cand_v.end(),
+                [](std::pair<int, int> const & a, std::pair<int, int> const & b) {
+                  return a.second > b.second || (a.second == b.second && a.first < b.first);
+                });
+
+      _cand_offsets.push_back(_cand_v.size());
+    }
+  }
+
+  //___________________________________________________________________________________________________
+  void RecoTrueMatcher::Match(lar_pandora::MCParticlesToPFParticles &matchedParticles,
+                              lar_pandora::MCParticlesToHits &matchedHits,
+                              bool recursiveMatching)
+  {
+    std::set<art::Ptr<recob::PFParticle>> recoVeto;
+    std::set<art::Ptr<simb::MCParticle>> trueVeto;
+    Match(matchedParticles, matchedHits, recoVeto, trueVeto, recursiveMatching);
+  }
+
+  //___________________________________________________________________________________________________
+  void RecoTrueMatcher::Match(lar_pandora::MCParticlesToPFParticles &matchedParticles,
+                              lar_pandora::MCParticlesToHits &matchedHits,
+                              std::set<art::Ptr<recob::PFParticle>> &recoVeto,
+                              std::set<art::Ptr<simb::MCParticle>> &trueVeto,
+                              bool recursiveMatching)
+  {
+    size_t n_reco = _reco_v.size();
+    size_t n_true = _true_v.size();
+
+    if (n_reco == 0) return;
+
+    std::vector<char> reco_vetoed(n_reco, 0);
+    std::vector<char> true_vetoed(n_true, 0);
+    for (auto const & p : recoVeto) { int r = RecoIndex(p); if (r != kNoMatch) reco_vetoed[r] = 1; }
+    for (auto const & p : trueVeto) { int t = TrueIndex(p); if (t != kNoMatch) true_vetoed[t] = 1; }
+
+    // Current winner per true particle: a reco index, or kNoMatch.
+    // Matches already in the output (if any) have to be beaten by a larger number of shared hits.
+    std::vector<int> winner(n_true, kNoMatch);
+    std::vector<int> winner_count(n_true, 0);
+    std::vector<char> has_match(n_true, 0);
+    for (auto const & iter : matchedHits) {
+      int t = TrueIndex(iter.first);
+      if (t == kNoMatch) continue;
+      has_match[t] = 1;
+      winner_count[t] = iter.second.size();
+    }
+
+    // Next candidate to look at, for each reco particle. Vetoed true particles
+    // are skipped lazily, when the reco particle has to propose again.
+    std::vector<size_t> cursor(_cand_offsets.begin(), _cand_offsets.end() - 1);
+
+    std::vector<int> active;
+    active.reserve(n_reco);
+    for (size_t r = 0; r < n_reco; r++) {
+      if (!reco_vetoed[r]) active.push_back(r);
+    }
+
+    std::priority_queue<Proposal> queue;
+    std::vector<size_t> round_trues;
+    bool first_round = true;
+
+    while (!active.empty()) {
+
+      // Every reco particle still active proposes its best non vetoed true particle
+      size_t n_active = 0;
+      for (int r : active) {
+
+        size_t & c = cursor[r];
+        while (c < _cand_offsets[r + 1] && true_vetoed[_cand_v[c].first]) c++;
+        if (c == _cand_offsets[r + 1]) continue;
+
+        queue.push(Proposal{_cand_v[c].second, r, _cand_v[c].first});
+        active[n_active++] = r;
+      }
+      active.resize(n_active);
+
+      // Resolve, best proposals first: only the first proposal to a true particle can win
+      round_trues.clear();
+      while (!queue.empty()) {
+
+        Proposal p = queue.top();
+        queue.pop();
+
+        if (winner[p.true_p] != kNoMatch) continue;
+        if (has_match[p.true_p] && p.n_hits <= winner_count[p.true_p]) continue;
+
+        has_match[p.true_p] = 1;
+        winner[p.true_p] = p.reco;
+        winner_count[p.true_p] = p.n_hits;
+        round_trues.push_back(p.true_p);
+      }
+
+      if (round_trues.empty()) return;
+
+      // Store the winners, and build their hit lists
+      for (size_t t : round_trues) {
+
+        int r = winner[t];
+
+        lar_pandora::HitVector & hit_v = matchedHits[_true_v[t]];
+        hit_v.clear();
+        hit_v.reserve(winner_count[t]);
+        for (size_t h = _reco_offsets[r]; h < _reco_offsets[r + 1]; h++) {
+          if (_reco_hit_true[h] == (int)t) hit_v.push_back(_reco_hit_v[h]);
+        }
+
+        matchedParticles[_true_v[t]] = _reco_v[r];
+      }
+
+      // Veto everything that is matched. After the first round, only
+      // the matches of this round can be new.
+      if (first_round) {
+        for (auto const & iter : matchedParticles) {
+          trueVeto.insert(iter.first);
+          recoVeto.insert(iter.second);
+
+          int t = TrueIndex(iter.first);
+          if (t != kNoMatch) true_vetoed[t] = 1;
+          int r = RecoIndex(iter.second);
+          if (r != kNoMatch) reco_vetoed[r] = 1;
+        }
+        first_round = false;
+      } else {
+        for (size_t t : round_trues) {
+          trueVeto.insert(_true_v[t]);
+          recoVeto.insert(_reco_v[winner[t]]);
+          true_vetoed[t] = 1;
+          reco_vetoed[winner[t]] = 1;
+        }
+      }
+
+      if (!recursiveMatching) return;
+
+      n_active = 0;
+      for (int r : active) {
+        if (!reco_vetoed[r]) active[n_active++] = r;
+      }
+      active.resize(n_active);
+    }
+  }
+}
+
+#endif
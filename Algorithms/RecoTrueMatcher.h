@@ -0,0 +1,134 @@
+/**
+ * \file RecoTrueMatcher.h
+ *
+ * \ingroup UBXSec
+ *
+ * \brief Reco (PFParticle) to true (MCParticle) matching on dense indices
+ *
+ * @author Marco Del Tutto
+ */
+
+/** \addtogroup UBXSec
+
+    @{*/
+
+#ifndef RECOTRUEMATCHER_H
+#define RECOTRUEMATCHER_H
+
+#include <iostream>
+#include <vector>
+#include <set>
+
+#include "lardataobj/RecoBase/PFParticle.h"
+#include "nusimdata/SimulationBase/MCParticle.h"
+#include "larpandora/LArPandoraInterface/LArPandoraHelper.h"
+
+namespace ubxsec {
+
+  /**
+   * \class RecoTrueMatcher
+   *
+   * Matches reconstructed particles to true particles by number of shared
+   * hits, with the same rules as the LArPandora matching:
+   *
+   *  - each reco particle proposes the (non vetoed) true particle it shares
+   *    most hits with, ties going to the first true particle in art::Ptr order;
+   *  - each true particle keeps the proposing reco particle with most
+   *    shared hits, ties going to the first reco particle in art::Ptr order;
+   *  - with recursive matching, matched particles are vetoed and the
+   *    unmatched reco particles propose again, until nothing new is matched.
+   *
+   * Hits, PFParticles and MCParticles are mapped once to dense integer
+   * indices, and all the (reco, true, shared hits) candidates are built
+   * once, each reco particle keeping its candidates sorted by preference.
+   * A matching round then only moves each reco particle past the candidates
+   * that got vetoed, and resolves the proposals from a priority queue, so
+   * recursive rounds do not recount hits. Hit lists are only built for
+   * the final matches.
+   */
+  class RecoTrueMatcher {
+
+  public:
+
+    /// Default constructor
+    RecoTrueMatcher() = default;
+
+    /// Default destructor
+    ~RecoTrueMatcher(){}
+
+    /**
+     *  @brief Builds the dense indices
+     *
+     *  @param recoParticlesToHits the mapping from reconstructed particles to hits
+     *  @param trueHitsToParticles the mapping from hits to true particles */
+    void Configure(const lar_pandora::PFParticlesToHits &recoParticlesToHits, const lar_pandora::HitsToMCParticles &trueHitsToParticles);
+
+    /**
+     *  @brief Performs the matching
+     *
+     *  @param matchedParticles the output matches between reconstructed and true particles
+     *  @param matchedHits the output matches between reconstructed particles and hits
+     *  @param recoVeto the veto list for reconstructed particles (input and output)
+     *  @param trueVeto the veto list for true particles (input and output)
+     *  @param recursiveMatching if true, repeats the matching on the particles not yet matched */
+    void Match(lar_pandora::MCParticlesToPFParticles &matchedParticles, lar_pandora::MCParticlesToHits &matchedHits,
+               std::set<art::Ptr<recob::PFParticle>> &recoVeto, std::set<art::Ptr<simb::MCParticle>> &trueVeto, bool recursiveMatching);
+
+    /// Performs the matching, no vetoes
+    void Match(lar_pandora::MCParticlesToPFParticles &matchedParticles, lar_pandora::MCParticlesToHits &matchedHits, bool recursiveMatching);
+
+    /// Returns the number of reco particles
+    size_t NReco() const { return _reco_v.size(); }
+
+    /// Returns the number of true particles
+    size_t NTrue() const { return _true_v.size(); }
+
+    /// Returns the number of hits of the reco particle, 0 if not known
+    int NRecoHits(art::Ptr<recob::PFParticle> const & part) const;
+
+    /// Returns the number of hits made by the true particle, 0 if not known
+    int NTrueHits(art::Ptr<simb::MCParticle> const & part) const;
+
+  protected:
+
+    static const int kNoMatch = -1;
+
+    /// Returns the dense index of the true particle that made the hit, kNoMatch if none
+    int HitToTrueIndex(art::Ptr<recob::Hit> const & hit) const;
+
+    /// Returns the dense index of the true particle, kNoMatch if not known
+    int TrueIndex(art::Ptr<simb::MCParticle> const & part) const;
+
+    /// Returns the dense index of the reco particle, kNoMatch if not known
+    int RecoIndex(art::Ptr<recob::PFParticle> const & part) const;
+
+    /// Builds the candidate list of each reco particle from the flattened hits
+    void BuildCandidates();
+
+    /// A reco particle proposing a true particle
+    struct Proposal {
+      int n_hits;  ///< Shared hits
+      int reco;    ///< Reco particle index
+      int true_p;  ///< True particle index
+      /// Priority queue order: most shared hits first, then first reco particle
+      bool operator<(Proposal const & o) const { return n_hits < o.n_hits || (n_hits == o.n_hits && reco > o.reco); }
+    };
+
+    std::vector<art::Ptr<recob::PFParticle>> _reco_v;  ///< Reco particles, in art::Ptr order
+    std::vector<art::Ptr<simb::MCParticle>>  _true_v;  ///< True particles, in art::Ptr order
+    std::vector<int>                         _true_n_hits; ///< Number of hits made by each true particle
+
+    std::vector<size_t>               _reco_offsets;   ///< Hits of reco r are [_reco_offsets[r], _reco_offsets[r+1])
+    std::vector<art::Ptr<recob::Hit>> _reco_hit_v;     ///< Hits of all the reco particles
+    std::vector<int>                  _reco_hit_true;  ///< True particle index of each hit in _reco_hit_v
+
+    /// Hit key -> true particle index, one table per hit data product
+    std::vector<std::pair<art::ProductID, std::vector<int>>> _hit_tables;
+
+    std::vector<size_t>              _cand_offsets;  ///< Candidates of reco r are [_cand_offsets[r], _cand_offsets[r+1])
+    std::vector<std::pair<int, int>> _cand_v;        ///< (true index, shared hits), most shared hits first, then lowest true index
+  };
+}
+
+#endif //  RECOTRUEMATCHER_H
+/** @} */ // end of doxygen group
@@ -0,0 +1,210 @@
+#ifndef SIMCHANNELBACKTRACKER_CXX
+#define SIMCHANNELBACKTRACKER_CXX
+
+#include "SimChannelBackTracker.h"
+
+#include "art/Framework/Principal/Handle.h"
+#include "canvas/Persistency/Common/FindOneP.h"
+#include "lardata/DetectorInfoServices/DetectorClocksService.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+
+namespace ubxsec {
+
+  SimChannelBackTracker::SimChannelBackTracker(art::Event const & e, std::string simchannel_producer, std::string mcparticle_producer)
+  {
+    Configure(e, simchannel_producer, mcparticle_producer);
+  }
+
+  //___________________________________________________________________________________________________
+  void SimChannelBackTracker::Configure(art::Event const & e, std::string simchannel_producer, std::string mcparticle_producer)
+  {
+    _ch_offsets.clear();
+    _deposit_v.clear();
+    _trackid_to_energy.clear();
+    _trackid_to_mother.clear();
+    _trackid_to_mctruth.clear();
+
+    art::Handle<std::vector<sim::SimChannel>> simch_h;
+    e.getByLabel(simchannel_producer, simch_h);
+    if (!simch_h.isValid()) {
+      std::cout << "[SimChannelBackTracker] Cannot locate SimChannels from " << simchannel_producer << "." << std::endl;
+      return;
+    }
+
+    // Count the deposits per channel first, so everything is stored in one go
+    raw::ChannelID_t max_channel = 0;
+    size_t n_deposits = 0;
+    for (auto const & simch : *simch_h) {
+      max_channel = std::max(max_channel, simch.Channel());
+      for (auto const & tdcide : simch.TDCIDEMap()) n_deposits += tdcide.second.size();
+    }
+
+    _ch_offsets.assign(simch_h->size() == 0 ? 1 : max_channel + 2, 0);
+    for (auto const & simch : *simch_h) {
+      for (auto const & tdcide : simch.TDCIDEMap()) _ch_offsets[simch.Channel() + 1] += tdcide.second.size();
+    }
+    for (size_t ch = 1; ch < _ch_offsets.size(); ch++) _ch_offsets[ch] += _ch_offsets[ch - 1];
+
+    _deposit_v.resize(n_deposits);
+    std::vector<size_t> fill(_ch_offsets.begin(), _ch_offsets.end() - 1);
+    std::vector<int> n_simch(_ch_offsets.size() - 1, 0);
+
+    for (auto const & simch : *simch_h) {
+
+      n_simch[simch.Channel()]++;
+      size_t & pos = fill[simch.Channel()];
+
+      // The TDC IDE map is ordered by TDC
+      for (auto const & tdcide : simch.TDCIDEMap()) {
+        for (auto const & ide : tdcide.second) {
+          int trackid = std::abs(ide.trackID);
+          _deposit_v[pos++] = Deposit{tdcide.first, trackid, ide.energy, ide.numElectrons};
+          _trackid_to_energy[trackid] += ide.energy;
+        }
+      }
+    }
+
+    // A channel in more than one SimChannel has its TDC runs one after the other
+    for (size_t ch = 0; ch < n_simch.size(); ch++) {
+      if (n_simch[ch] < 2) continue;
+      std::stable_sort(_deposit_v.begin() + _ch_offsets[ch], _deposit_v.begin() + _ch_offsets[ch + 1],
+                       [](Deposit const & a, Deposit const & b) { return a.tdc < b.tdc; });
+    }
+
+    // Mothers, to go from track ID to eve ID
+    art::Handle<std::vector<simb::MCParticle>> mcp_h;
+    e.getByLabel(mcparticle_producer, mcp_h);
+    if (!mcp_h.isValid()) {
+      std::cout << "[SimChannelBackTracker] Cannot locate MCParticles from " << mcparticle_producer << ", eve IDs will be the track IDs." << std::endl;
+      return;
+    }
+
+    _trackid_to_mother.reserve(mcp_h->size());
+    for (auto const & mcp : *mcp_h) {
+      _trackid_to_mother[mcp.TrackId()] = mcp.Mother();
+    }
+
+    // MCTruth of each particle, from the associations made by the MCParticle producer
+    art::FindOneP<simb::MCTruth> mcp_to_mct(mcp_h, e, mcparticle_producer);
+    if (!mcp_to_mct.isValid()) {
+      std::cout << "[SimChannelBackTracker] Cannot locate MCParticle to MCTruth associations from " << mcparticle_producer << "." << std::endl;
+      return;
+    }
+
+    _trackid_to_mctruth.reserve(mcp_h->size());
+    for (size_t i = 0; i < mcp_h->size(); i++) {
+      _trackid_to_mctruth[(*mcp_h)[i].TrackId()] = mcp_to_mct.at(i);
+    }
+  }
+
+  //___________________________________________________________________________________________________
+  void SimChannelBackTracker::ChannelToTrackIDEs(std::vector<sim::TrackIDE> & trackides,
+                                                 raw::ChannelID_t channel,
+                                                 unsigned int start_tdc,
+                                                 unsigned int end_tdc) const
+  {
+    trackides.clear();
+
+    if ((size_t)channel + 1 >= _ch_offsets.size()) return;
+
+    auto begin = _deposit_v.begin() + _ch_offsets[channel];
+    auto end   = _deposit_v.begin() + _ch_offsets[channel + 1];
+
+    auto it = std::lower_bound(begin, end, start_tdc,
+                               [](Deposit const & d, unsigned int tdc) { return d.tdc < tdc; });
+
+    std::map<int, sim::TrackIDE> trackid_to_ide;
+    double total_energy = 0;
+
+    for (; it != end && it->tdc <= end_tdc; ++it) {
+      sim::TrackIDE & tide = trackid_to_ide[it->trackid];
+      tide.trackID       = it->trackid;
+      tide.energy       += it->energy;
+      tide.numElectrons += it->numElectrons;
+      total_energy      += it->energy;
+    }
+
+    trackides.reserve(trackid_to_ide.size());
+    for (auto & iter : trackid_to_ide) {
+      iter.second.energyFrac = (total_energy > 0 ? iter.second.energy / total_energy : 0.);
+      trackides.push_back(iter.second);
+    }
+  }
+
+  //___________________________________________________________________________________________________
+  std::vector<sim::TrackIDE> SimChannelBackTracker::HitToTrackID(art::Ptr<recob::Hit> const & hit) const
+  {
+    auto const * ts = lar::providerFrom<detinfo::DetectorClocksService>();
+
+    int start_tdc = ts->TPCTick2TDC(hit->StartTick());
+    int end_tdc   = ts->TPCTick2TDC(hit->EndTick());
+    if (start_tdc < 0) start_tdc = 0;
+    if (end_tdc < 0)   end_tdc = 0;
+
+    std::vector<sim::TrackIDE> trackides;
+    ChannelToTrackIDEs(trackides, hit->Channel(), start_tdc, end_tdc);
+
+    return trackides;
+  }
+
+  //___________________________________________________________________________________________________
+  std::vector<sim::TrackIDE> SimChannelBackTracker::HitToEveID(art::Ptr<recob::Hit> const & hit) const
+  {
+    std::map<int, double> eve_to_energy;
+    double total_energy = 0;
+
+    for (auto const & tide : HitToTrackID(hit)) {
+      eve_to_energy[TrackIDToEveID(tide.trackID)] += tide.energy;
+      total_energy += tide.energy;
+    }
+
+    std::vector<sim::TrackIDE> eveides;
+    eveides.reserve(eve_to_energy.size());
+    for (auto const & iter : eve_to_energy) {
+      sim::TrackIDE tide;
+      tide.trackID    = iter.first;
+      tide.energy     = iter.second;
+      tide.energyFrac = (total_energy > 0 ? iter.second / total_energy : 0.);
+      eveides.push_back(tide);
+    }
+
+    return eveides;
+  }
+
+  //___________________________________________________________________________________________________
+  double SimChannelBackTracker::TrackIDToTotalEnergy(int trackid) const
+  {
+    auto it = _trackid_to_energy.find(std::abs(trackid));
+    if (it == _trackid_to_energy.end()) return 0.;
+    return it->second;
+  }
+
+  //___________________________________________________________________________________________________
+  int SimChannelBackTracker::TrackIDToEveID(int trackid) const
+  {
+    int eveid = trackid;
+
+    // Guard against loops in the mother chain
+    for (size_t n = 0; n <= _trackid_to_mother.size(); n++) {
+      auto it = _trackid_to_mother.find(eveid);
+      if (it == _trackid_to_mother.end()) return eveid;
+      if (it->second == 0) return eveid;
+      eveid = it->second;
+    }
+
+    return eveid;
+  }
+
+  //___________________________________________________________________________________________________
+  art::Ptr<simb::MCTruth> SimChannelBackTracker::TrackIDToMCTruth(int trackid) const
+  {
+    auto it = _trackid_to_mctruth.find(std::abs(trackid));
+    if (it == _trackid_to_mctruth.end()) return art::Ptr<simb::MCTruth>();
+    return it->second;
+  }
+}
+
+#endif
@@ -0,0 +1,102 @@
+/**
+ * \file SimChannelBackTracker.h
+ *
+ * \ingroup UBXSec
+ *
+ * \brief Hit backtracking from an index of the SimChannels
+ *
+ * @author Marco Del Tutto
+ */
+
+/** \addtogroup UBXSec
+
+    @{*/
+
+#ifndef SIMCHANNELBACKTRACKER_H
+#define SIMCHANNELBACKTRACKER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "art/Framework/Principal/Event.h"
+#include "canvas/Persistency/Common/Ptr.h"
+#include "lardataobj/RecoBase/Hit.h"
+#include "lardataobj/Simulation/SimChannel.h"
+#include "nusimdata/SimulationBase/MCParticle.h"
+#include "nusimdata/SimulationBase/MCTruth.h"
+
+namespace ubxsec {
+
+  /**
+   * \class SimChannelBackTracker
+   *
+   * Answers the hit -> track ID queries of cheat::BackTracker
+   * (HitToTrackID, HitToEveID, and the total energy of a track ID) from a
+   * per-event index of the sim::SimChannel, without the BackTracker
+   * service.
+   *
+   * For each channel, the energy depositions are stored flat and ordered
+   * by TDC, so the depositions in the time window of a hit are found with
+   * a binary search. Track IDs are the absolute values of the IDE ones, as
+   * in the BackTracker, and eve IDs follow the MCParticle mothers up to
+   * the primary (or to the first particle not in the list). The MCTruth
+   * of a track ID comes from the MCParticle -> MCTruth associations of
+   * the MCParticle producer.
+   */
+  class SimChannelBackTracker {
+
+  public:
+
+    /// Default constructor, the index is empty until Configure is called
+    SimChannelBackTracker() = default;
+
+    /// Constructor, builds the index
+    SimChannelBackTracker(art::Event const & e, std::string simchannel_producer, std::string mcparticle_producer);
+
+    /// Default destructor
+    ~SimChannelBackTracker(){}
+
+    /// Builds the index from the SimChannels and MCParticles of the event, replacing the current content
+    void Configure(art::Event const & e, std::string simchannel_producer, std::string mcparticle_producer);
+
+    /// Returns the track IDs (energy, energy fraction) that deposited charge in the time window of the hit
+    std::vector<sim::TrackIDE> HitToTrackID(art::Ptr<recob::Hit> const & hit) const;
+
+    /// Returns the eve IDs (energy, energy fraction) that deposited charge in the time window of the hit
+    std::vector<sim::TrackIDE> HitToEveID(art::Ptr<recob::Hit> const & hit) const;
+
+    /// Returns the total energy deposited by the track ID, on all the channels
+    double TrackIDToTotalEnergy(int trackid) const;
+
+    /// Returns the eve ID of the track ID
+    int TrackIDToEveID(int trackid) const;
+
+    /// Returns the MCTruth the track ID comes from, a null Ptr if the track ID is unknown
+    art::Ptr<simb::MCTruth> TrackIDToMCTruth(int trackid) const;
+
+  private:
+
+    /// Returns the energy deposited per track ID on the channel, for TDC in [start_tdc, end_tdc]
+    void ChannelToTrackIDEs(std::vector<sim::TrackIDE> & trackides, raw::ChannelID_t channel, unsigned int start_tdc, unsigned int end_tdc) const;
+
+    /// A deposition: TDC, track ID (absolute value), energy and number of electrons
+    struct Deposit {
+      unsigned int tdc;
+      int trackid;
+      float energy;
+      float numElectrons;
+    };
+
+    std::vector<size_t>  _ch_offsets;   ///< Deposits of channel ch are [_ch_offsets[ch], _ch_offsets[ch+1])
+    std::vector<Deposit> _deposit_v;    ///< Deposits of all the channels, ordered by channel, then by TDC
+
+    std::unordered_map<int, double> _trackid_to_energy;  ///< Track ID -> total deposited energy
+    std::unordered_map<int, int>    _trackid_to_mother;  ///< Track ID -> mother track ID
+    std::unordered_map<int, art::Ptr<simb::MCTruth>> _trackid_to_mctruth; ///< Track ID -> MCTruth
+  };
+}
+
+#endif //  SIMCHANNELBACKTRACKER_H
+/** @} */ // end of doxygen group
@@ -0,0 +1,90 @@
+#ifndef TRACKSUMMARYTABLE_CXX
+#define TRACKSUMMARYTABLE_CXX
+
+#include "TrackSummaryTable.h"
+
+#include <algorithm>
+
+namespace ubxsec {
+
+  void TrackSummaryTable::Clear()
+  {
+    _product_id = art::ProductID();
+    Resize(0);
+  }
+
+  //___________________________________________________________________________________________________
+  void TrackSummaryTable::Resize(size_t n)
+  {
+    _filled.assign(n, 0);
+
+    for (auto col : {&_length,
+                     &_start_x, &_start_y, &_start_z,
+                     &_end_x, &_end_y, &_end_z,
+                     &_start_dir_x, &_start_dir_y, &_start_dir_z,
+                     &_end_dir_x, &_end_dir_y, &_end_dir_z,
+                     &_chi2}) {
+      col->assign(n, 0.);
+    }
+    _ndof.assign(n, 0);
+  }
+
+  //___________________________________________________________________________________________________
+  void TrackSummaryTable::FillEntry(size_t key, recob::Track const & track)
+  {
+    _filled[key] = 1;
+
+    _length[key] = track.Length();
+
+    TVector3 start = track.Vertex();
+    _start_x[key] = start.X(); _start_y[key] = start.Y(); _start_z[key] = start.Z();
+
+    TVector3 end = track.End();
+    _end_x[key] = end.X(); _end_y[key] = end.Y(); _end_z[key] = end.Z();
+
+    TVector3 start_dir = track.VertexDirection();
+    _start_dir_x[key] = start_dir.X(); _start_dir_y[key] = start_dir.Y(); _start_dir_z[key] = start_dir.Z();
+
+    TVector3 end_dir = track.EndDirection();
+    _end_dir_x[key] = end_dir.X(); _end_dir_y[key] = end_dir.Y(); _end_dir_z[key] = end_dir.Z();
+
+    _chi2[key] = track.Chi2();
+    _ndof[key] = track.Ndof();
+  }
+
+  //___________________________________________________________________________________________________
+  void TrackSummaryTable::Fill(lar_pandora::TrackVector const & track_v)
+  {
+    Clear();
+
+    if (track_v.empty()) return;
+
+    _product_id = track_v.front().id();
+
+    size_t max_key = 0;
+    for (auto const & trk : track_v) max_key = std::max(max_key, trk.key());
+    Resize(max_key + 1);
+
+    for (auto const & trk : track_v) {
+      if (!(trk.id() == _product_id)) {
+        std::cout << "[TrackSummaryTable] Tracks from more than one product, skipping key " << trk.key() << std::endl;
+        continue;
+      }
+      FillEntry(trk.key(), *trk);
+    }
+  }
+
+  //___________________________________________________________________________________________________
+  void TrackSummaryTable::Fill(std::vector<recob::Track> const & track_v)
+  {
+    Clear();
+
+    Resize(track_v.size());
+
+    for (size_t key = 0; key < track_v.size(); key++) {
+      FillEntry(key, track_v[key]);
+    }
+  }
+}
+
+#endif
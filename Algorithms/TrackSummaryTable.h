@@ -0,0 +1,144 @@
+/**
+ * \file TrackSummaryTable.h
+ *
+ * \ingroup UBXSec
+ *
+ * \brief Per-event track lengths, end points, directions and fit quality, indexed by track key
+ *
+ * @author Marco Del Tutto
+ */
+
+/** \addtogroup UBXSec
+
+    @{*/
+
+#ifndef TRACKSUMMARYTABLE_H
+#define TRACKSUMMARYTABLE_H
+
+#include <iostream>
+#include <vector>
+
+#include "lardataobj/RecoBase/Track.h"
+#include "larpandora/LArPandoraInterface/LArPandoraHelper.h"
+
+#include "TVector3.h"
+
+namespace ubxsec {
+
+  /**
+   * \class TrackSummaryTable
+   *
+   * recob::Track::Length() walks the whole trajectory at every call, and
+   * copying a track copies its trajectory. This table computes length,
+   * start and end points, start and end directions and the fit chi2 and
+   * degrees of freedom once per track,
+   * and stores them in separate arrays (one per quantity) indexed by the
+   * art::Ptr key of the track.
+   *
+   * The Ptr accessors fall back to the track itself if the track is not
+   * in the table, so callers do not need to check.
+   */
+  class TrackSummaryTable {
+
+  public:
+
+    /// Default constructor
+    TrackSummaryTable() = default;
+
+    /// Default destructor
+    ~TrackSummaryTable(){}
+
+    /// Fills the table from tracks of the same product
+    void Fill(lar_pandora::TrackVector const & track_v);
+
+    /// Fills the table from a full track collection, the key is the index in the collection
+    void Fill(std::vector<recob::Track> const & track_v);
+
+    /// Empties the table
+    void Clear();
+
+    /// Returns the size of the table (max key + 1)
+    size_t size() const { return _length.size(); }
+
+    /// Returns true if the track with the key passed is in the table
+    bool Has(size_t key) const { return key < _filled.size() && _filled[key]; }
+
+    /// Returns true if the track is in the table
+    bool Has(art::Ptr<recob::Track> const & trk) const { return trk.id() == _product_id && Has(trk.key()); }
+
+    /// Returns the length of the track with the key passed
+    double Length(size_t key) const { return _length[key]; }
+
+    /// Returns the start point of the track with the key passed
+    TVector3 Start(size_t key) const { return TVector3(_start_x[key], _start_y[key], _start_z[key]); }
+
+    /// Returns the end point of the track with the key passed
+    TVector3 End(size_t key) const { return TVector3(_end_x[key], _end_y[key], _end_z[key]); }
+
+    /// Returns the direction at the start of the track with the key passed
+    TVector3 StartDirection(size_t key) const { return TVector3(_start_dir_x[key], _start_dir_y[key], _start_dir_z[key]); }
+
+    /// Returns the direction at the end of the track with the key passed
+    TVector3 EndDirection(size_t key) const { return TVector3(_end_dir_x[key], _end_dir_y[key], _end_dir_z[key]); }
+
+    /// Returns the fit chi2 of the track with the key passed
+    double Chi2(size_t key) const { return _chi2[key]; }
+
+    /// Returns the fit degrees of freedom of the track with the key passed
+    int Ndof(size_t key) const { return _ndof[key]; }
+
+    /// Returns the length of the track
+    double Length(art::Ptr<recob::Track> const & trk) const { return Has(trk) ? Length(trk.key()) : trk->Length(); }
+
+    /// Returns the start point of the track
+    TVector3 Start(art::Ptr<recob::Track> const & trk) const { return Has(trk) ? Start(trk.key()) : trk->Vertex(); }
+
+    /// Returns the end point of the track
+    TVector3 End(art::Ptr<recob::Track> const & trk) const { return Has(trk) ? End(trk.key()) : trk->End(); }
+
+    /// Returns the direction at the start of the track
+    TVector3 StartDirection(art::Ptr<recob::Track> const & trk) const { return Has(trk) ? StartDirection(trk.key()) : trk->VertexDirection(); }
+
+    /// Returns the direction at the end of the track
+    TVector3 EndDirection(art::Ptr<recob::Track> const & trk) const { return Has(trk) ? EndDirection(trk.key()) : trk->EndDirection(); }
+
+    /// Returns the fit chi2 of the track
+    double Chi2(art::Ptr<recob::Track> const & trk) const { return Has(trk) ? Chi2(trk.key()) : trk->Chi2(); }
+
+    /// Returns the fit degrees of freedom of the track
+    int Ndof(art::Ptr<recob::Track> const & trk) const { return Has(trk) ? Ndof(trk.key()) : trk->Ndof(); }
+
+    /// Column accessors, for batch processing (one entry per key)
+    std::vector<double> const & Lengths() const { return _length; }
+    std::vector<double> const & StartX()  const { return _start_x; }
+    std::vector<double> const & StartY()  const { return _start_y; }
+    std::vector<double> const & StartZ()  const { return _start_z; }
+    std::vector<double> const & EndX()    const { return _end_x; }
+    std::vector<double> const & EndY()    const { return _end_y; }
+    std::vector<double> const & EndZ()    const { return _end_z; }
+    std::vector<double> const & Chi2s()   const { return _chi2; }
+    std::vector<int>    const & Ndofs()   const { return _ndof; }
+
+  private:
+
+    /// Resizes all the columns
+    void Resize(size_t n);
+
+    /// Fills the entry with the key passed
+    void FillEntry(size_t key, recob::Track const & track);
+
+    art::ProductID _product_id;  ///< Product of the tracks (if filled from art::Ptr)
+    std::vector<char> _filled;   ///< True if the key is in the table
+
+    std::vector<double> _length;                                ///< Track length
+    std::vector<double> _start_x, _start_y, _start_z;           ///< Start point
+    std::vector<double> _end_x, _end_y, _end_z;                 ///< End point
+    std::vector<double> _start_dir_x, _start_dir_y, _start_dir_z; ///< Direction at the start point
+    std::vector<double> _end_dir_x, _end_dir_y, _end_dir_z;     ///< Direction at the end point
+    std::vector<double> _chi2;                                  ///< Fit chi2
+    std::vector<int>    _ndof;                                  ///< Fit degrees of freedom
+  };
+}
+
+#endif //  TRACKSUMMARYTABLE_H
+/** @} */ // end of doxygen group
@@ -49,49 +49,96 @@
 
 
 
-//___________________________________________________________________________________________________
-void UBXSecHelper::GetTrackPurityAndEfficiency( lar_pandora::HitVector recoHits, double & trackPurity, double & trackEfficiency ) {
+namespace {
 
-  art::ServiceHandle<cheat::BackTracker> bt;
+  // Purity and efficiency from any backtracker answering HitToEveID and TrackIDToTotalEnergy
+  template <typename BT>
+  void TrackPurityAndEfficiency( BT & bt, lar_pandora::HitVector const & recoHits, double & trackPurity, double & trackEfficiency ) {
 
-  // map from geant track id to true track deposited energy
-  std::map<int,double> trkidToIDE;
+    // map from geant track id to true track deposited energy
+    std::map<int,double> trkidToIDE;
 
-  for(size_t h = 0; h < recoHits.size(); h++){
+    for(size_t h = 0; h < recoHits.size(); h++){
 
-    art::Ptr<recob::Hit> recoHit = recoHits[h];
-    std::vector<sim::TrackIDE> eveIDs = bt->HitToEveID(recoHit);
+      std::vector<sim::TrackIDE> const & eveIDs = bt.HitToEveID(recoHits[h]);
 
-    for(size_t e = 0; e < eveIDs.size(); ++e){
-      //std::cout<<"[Hit "<< h<<"] hit plane: "<<recoHit->View()<<" "<<e<<" "<<eveIDs[e].trackID<<" "<<eveIDs[e].energy<<" "<<eveIDs[e].energyFrac<<"   pdg "<< (bt->TrackIDToParticle(eveIDs[e].trackID))->PdgCode()<<"   process "<<(bt->TrackIDToParticle(eveIDs[e].trackID))->Process()<<std::endl;
-      trkidToIDE[eveIDs[e].trackID] += eveIDs[e].energy;
+      for(size_t e = 0; e < eveIDs.size(); ++e){
+        trkidToIDE[eveIDs[e].trackID] += eveIDs[e].energy;
+      }
+    }
+
+    // No true energy associated to these hits
+    if (trkidToIDE.empty()) return;
+
+    double maxe = -1;
+    double tote = 0;
+    int trackid;
+    for(auto const& ii : trkidToIDE){
+      tote += ii.second;
+      if ((ii.second)>maxe){
+        maxe = ii.second;
+        trackid = ii.first;
+      }
     }
-  }
 
-  double maxe = -1;
-  double tote = 0;
-  int trackid;
-  for(auto const& ii : trkidToIDE){
-    tote += ii.second;
-    if ((ii.second)>maxe){
-      maxe = ii.second;
-      trackid = ii.first;
+    if (tote>0){
+      trackPurity = maxe/tote;
     }
+
+    double totalEnergyFromMainTrack = bt.TrackIDToTotalEnergy(trackid);
+
+    trackEfficiency = maxe/(totalEnergyFromMainTrack); //totalEnergyFromMainTrack includes both inductions and collection energies
+
+    return;
   }
 
-  if (tote>0){
-    trackPurity = maxe/tote;
+  // FV top boundary crossing from the track end points
+  bool CrossingTopBoundary(const ubxsec::FiducialVolume & fv, double * vtx, double * end, int & vtx_ok, std::ostream & log)
+  {
+    log << "VTX X " <<vtx[0] << "Y " <<vtx[1] << "Z " <<vtx[2] << std::endl;
+    log << "END X " <<end[0] << "Y " <<end[1] << "Z " <<end[2] << std::endl;
+
+    unsigned char flags = fv.ClassifyTrack(vtx, end);
+
+    if (flags & ubxsec::FiducialVolume::kCrossingTop) {
+      vtx_ok = ubxsec::FiducialVolume::VertexOk(flags);
+      if (vtx_ok == 0) log << "Crossing top boundary, vertex is in FV" << std::endl;
+      else             log << "Crossing top boundary, end is in FV" << std::endl;
+      return true;
+    }
+
+    vtx_ok = -1;
+    return false;
   }
 
-  std::vector<sim::IDE> vide(bt->TrackIDToSimIDE(trackid)); 
-  double totalEnergyFromMainTrack = 0;
-  for (const sim::IDE& ide: vide) {
-    totalEnergyFromMainTrack += ide.energy;
+  // FV boundary crossing from the track end points
+  bool CrossingBoundary(const ubxsec::FiducialVolume & fv, double * vtx, double * end, int & vtx_ok)
+  {
+    unsigned char flags = fv.ClassifyTrack(vtx, end);
+
+    vtx_ok = ubxsec::FiducialVolume::VertexOk(flags);
+
+    return (flags & ubxsec::FiducialVolume::kCrossing);
   }
+}
 
-  trackEfficiency = maxe/(totalEnergyFromMainTrack); //totalEnergyFromMainTrack includes both inductions and collection energies
+//___________________________________________________________________________________________________
+void UBXSecHelper::GetTrackPurityAndEfficiency( lar_pandora::HitVector recoHits, double & trackPurity, double & trackEfficiency ) {
 
-  return;
+  ubxsec::BackTrackerCache bt_cache;
+  GetTrackPurityAndEfficiency(bt_cache, recoHits, trackPurity, trackEfficiency);
+}
+
+//___________________________________________________________________________________________________
+void UBXSecHelper::GetTrackPurityAndEfficiency( ubxsec::BackTrackerCache & bt_cache, lar_pandora::HitVector const & recoHits, double & trackPurity, double & trackEfficiency ) {
+
+  TrackPurityAndEfficiency(bt_cache, recoHits, trackPurity, trackEfficiency);
+}
+
+//___________________________________________________________________________________________________
+void UBXSecHelper::GetTrackPurityAndEfficiency( ubxsec::SimChannelBackTracker const & bt, lar_pandora::HitVector const & recoHits, double & trackPurity, double & trackEfficiency ) {
+
+  TrackPurityAndEfficiency(bt, recoHits, trackPurity, trackEfficiency);
 }
 
 
@@ -174,76 +221,9 @@ void UBXSecHelper::GetRecoToTrueMatches(const lar_pandora::PFParticlesToHits &re
                                            MCParticleSet &vetoTrue,
                                            bool _recursiveMatching) 
 {
-    bool foundMatches(false);
-
-    // Loop over the reco particles
-    for (lar_pandora::PFParticlesToHits::const_iterator iter1 = recoParticlesToHits.begin(), iterEnd1 = recoParticlesToHits.end();
-        iter1 != iterEnd1; ++iter1)
-    {
-        const art::Ptr<recob::PFParticle> recoParticle = iter1->first;
-        if (vetoReco.count(recoParticle) > 0)
-            continue;
-
-        const lar_pandora::HitVector &hitVector = iter1->second;
-
-        lar_pandora::MCParticlesToHits truthContributionMap;
-
-        // Loop over all the hits associated to this reco particle
-        for (lar_pandora::HitVector::const_iterator iter2 = hitVector.begin(), iterEnd2 = hitVector.end(); iter2 != iterEnd2; ++iter2)
-        {
-            const art::Ptr<recob::Hit> hit = *iter2;
-
-            lar_pandora::HitsToMCParticles::const_iterator iter3 = trueHitsToParticles.find(hit);
-            if (trueHitsToParticles.end() == iter3)
-                continue;
-
-            const art::Ptr<simb::MCParticle> trueParticle = iter3->second;
-            if (vetoTrue.count(trueParticle) > 0)
-                continue;
-
-            // This map will contain all the true particles that match some or all of the hits of the reco particle
-            truthContributionMap[trueParticle].push_back(hit);
-        }
-
-        // Now we want to find the true particle that has more hits in common with this reco particle than the others
-        lar_pandora::MCParticlesToHits::const_iterator mIter = truthContributionMap.end();
-
-        for (lar_pandora::MCParticlesToHits::const_iterator iter4 = truthContributionMap.begin(), iterEnd4 = truthContributionMap.end();
-            iter4 != iterEnd4; ++iter4)
-        {
-            if ((truthContributionMap.end() == mIter) || (iter4->second.size() > mIter->second.size()))
-            {
-                mIter = iter4;
-            }
-        }
-
-        if (truthContributionMap.end() != mIter)
-        {
-            const art::Ptr<simb::MCParticle> trueParticle = mIter->first;
-
-            lar_pandora::MCParticlesToHits::const_iterator iter5 = matchedHits.find(trueParticle);
-
-            if ((matchedHits.end() == iter5) || (mIter->second.size() > iter5->second.size()))
-            {
-                matchedParticles[trueParticle] = recoParticle;
-                matchedHits[trueParticle] = mIter->second;
-                foundMatches = true;
-            }
-        }
-    } // recoParticlesToHits loop ends
-
-    if (!foundMatches)
-        return;
-
-    for (lar_pandora::MCParticlesToPFParticles::const_iterator pIter = matchedParticles.begin(), pIterEnd = matchedParticles.end();
-        pIter != pIterEnd; ++pIter)
-    {
-        vetoTrue.insert(pIter->first);
-        vetoReco.insert(pIter->second);
-    }
-
-    if (_recursiveMatching)
-        GetRecoToTrueMatches(recoParticlesToHits, trueHitsToParticles, matchedParticles, matchedHits, vetoReco, vetoTrue, _recursiveMatching);
+    ubxsec::RecoTrueMatcher matcher;
+    matcher.Configure(recoParticlesToHits, trueHitsToParticles);
+    matcher.Match(matchedParticles, matchedHits, vetoReco, vetoTrue, _recursiveMatching);
 }
 
 
@@ -509,10 +489,73 @@ art::Ptr<recob::PFParticle> UBXSecHelper::GetNuPFP(lar_pandora::PFParticleVector
 
 
 //______________________________________________________________________________________
-void UBXSecHelper::GetTPCObjects(lar_pandora::PFParticleVector pfParticleList, 
-                                 lar_pandora::PFParticlesToTracks pfParticleToTrackMap, 
-                                 lar_pandora::PFParticlesToVertices  pfParticleToVertexMap, 
-                                 std::vector<lar_pandora::PFParticleVector> & pfp_v_v, 
+void UBXSecHelper::GetTPCObjects(ubxsec::PandoraEventCache const & cache,
+                                 std::vector<ubana::TPCObjectSlice> & slice_v) {
+
+  slice_v.clear();
+
+  std::cout << "[UBXSecHelper] Getting TPC Objects..." << std::endl;
+
+  ubxsec::PFPHierarchy const & hierarchy = cache.GetPFPHierarchy();
+  std::vector<size_t> pfp_indices;
+
+  for (unsigned int n = 0; n < hierarchy.size(); ++n) {
+    const art::Ptr<recob::PFParticle> particle = hierarchy.GetPFP(n);
+
+    if(!lar_pandora::LArPandoraHelper::IsNeutrino(particle)) continue;
+
+    std::cout << "[UBXSecHelper] \t Creating TPC Object " << slice_v.size() << std::endl;
+
+    slice_v.emplace_back();
+    ubana::TPCObjectSlice & slice = slice_v.back();
+    slice.nu_pfp = particle;
+
+    lar_pandora::VertexVector const & nu_vertex_v = cache.GetVertices(particle);
+    if (nu_vertex_v.size() > 1)
+      std::cout << "More than one vertex associated to neutrino PFP!" << std::endl;
+    else if (nu_vertex_v.size() == 0)
+      std::cout << "Zero vertices associated to neutrino PFP!" << std::endl;
+    else
+      slice.nu_vertex = nu_vertex_v[0];
+
+    pfp_indices.clear();
+    hierarchy.CollectHierarchy(n, pfp_indices);
+
+    slice.pfp_v.reserve(pfp_indices.size());
+    for (size_t index : pfp_indices) {
+      art::Ptr<recob::PFParticle> const & pfp = hierarchy.GetPFP(index);
+      slice.pfp_v.emplace_back(pfp);
+
+      lar_pandora::TrackVector const & tracks = cache.GetTracks(pfp);
+      slice.track_v.insert(slice.track_v.end(), tracks.begin(), tracks.end());
+
+      lar_pandora::ShowerVector const & showers = cache.GetShowers(pfp);
+      slice.shower_v.insert(slice.shower_v.end(), showers.begin(), showers.end());
+    }
+
+    std::cout << "[UBXSecHelper] \t Number of pfp for this TPC object: "     << slice.pfp_v.size()    << std::endl;
+    std::cout << "[UBXSecHelper] \t Number of tracks for this TPC object: "  << slice.track_v.size()  << std::endl;
+    std::cout << "[UBXSecHelper] \t Number of showers for this TPC object: " << slice.shower_v.size() << std::endl;
+  } // end pfp loop
+}
+
+//______________________________________________________________________________________
+void UBXSecHelper::GetTPCObjects(lar_pandora::PFParticleVector const & pfParticleList,
+                                 lar_pandora::PFParticlesToTracks const & pfParticleToTrackMap,
+                                 lar_pandora::PFParticlesToVertices const & pfParticleToVertexMap,
+                                 std::vector<lar_pandora::PFParticleVector> & pfp_v_v,
+                                 std::vector<lar_pandora::TrackVector> & track_v_v) {
+
+  ubxsec::PFPHierarchy hierarchy(pfParticleList);
+
+  GetTPCObjects(hierarchy, pfParticleToTrackMap, pfParticleToVertexMap, pfp_v_v, track_v_v);
+}
+
+//______________________________________________________________________________________
+void UBXSecHelper::GetTPCObjects(ubxsec::PFPHierarchy const & hierarchy,
+                                 lar_pandora::PFParticlesToTracks const & pfParticleToTrackMap,
+                                 lar_pandora::PFParticlesToVertices const & pfParticleToVertexMap,
+                                 std::vector<lar_pandora::PFParticleVector> & pfp_v_v,
                                  std::vector<lar_pandora::TrackVector> & track_v_v) {
 
   track_v_v.clear();
@@ -520,8 +563,8 @@ void UBXSecHelper::GetTPCObjects(lar_pandora::PFParticleVector pfParticleList,
 
   std::cout << "[UBXSecHelper] Getting TPC Objects..." << std::endl;
 
-  for (unsigned int n = 0; n < pfParticleList.size(); ++n) {
-    const art::Ptr<recob::PFParticle> particle = pfParticleList.at(n);
+  for (unsigned int n = 0; n < hierarchy.size(); ++n) {
+    const art::Ptr<recob::PFParticle> particle = hierarchy.GetPFP(n);
 
     if(lar_pandora::LArPandoraHelper::IsNeutrino(particle)) {
       std::cout << "[UBXSecHelper] \t Creating TPC Object " << track_v_v.size() << std::endl;
@@ -539,7 +582,7 @@ void UBXSecHelper::GetTPCObjects(lar_pandora::PFParticleVector pfParticleList,
       lar_pandora::TrackVector track_v;
       lar_pandora::PFParticleVector pfp_v;
 
-      CollectTracksAndPFP(pfParticleToTrackMap, pfParticleList, particle, pfp_v, track_v);
+      CollectTracksAndPFP(hierarchy, pfParticleToTrackMap, particle, pfp_v, track_v);
 
       pfp_v_v.emplace_back(pfp_v);
       track_v_v.emplace_back(track_v);
@@ -567,10 +610,22 @@ void UBXSecHelper::GetTPCObjects(lar_pandora::PFParticleVector pfParticleList,
 
 
 //______________________________________________________________________________________
-void UBXSecHelper::GetTPCObjects(lar_pandora::PFParticleVector pfParticleList, 
-                                 lar_pandora::PFParticlesToShowers pfParticleToShowerMap, 
-                                 lar_pandora::PFParticlesToVertices  pfParticleToVertexMap, 
-                                 std::vector<lar_pandora::PFParticleVector> & pfp_v_v, 
+void UBXSecHelper::GetTPCObjects(lar_pandora::PFParticleVector const & pfParticleList,
+                                 lar_pandora::PFParticlesToShowers const & pfParticleToShowerMap,
+                                 lar_pandora::PFParticlesToVertices const & pfParticleToVertexMap,
+                                 std::vector<lar_pandora::PFParticleVector> & pfp_v_v,
+                                 std::vector<lar_pandora::ShowerVector> & shower_v_v) {
+
+  ubxsec::PFPHierarchy hierarchy(pfParticleList);
+
+  GetTPCObjects(hierarchy, pfParticleToShowerMap, pfParticleToVertexMap, pfp_v_v, shower_v_v);
+}
+
+//______________________________________________________________________________________
+void UBXSecHelper::GetTPCObjects(ubxsec::PFPHierarchy const & hierarchy,
+                                 lar_pandora::PFParticlesToShowers const & pfParticleToShowerMap,
+                                 lar_pandora::PFParticlesToVertices const & pfParticleToVertexMap,
+                                 std::vector<lar_pandora::PFParticleVector> & pfp_v_v,
                                  std::vector<lar_pandora::ShowerVector> & shower_v_v) {
 
   shower_v_v.clear();
@@ -578,8 +633,8 @@ void UBXSecHelper::GetTPCObjects(lar_pandora::PFParticleVector pfParticleList,
 
   std::cout << "[UBXSecHelper] Getting TPC Objects..." << std::endl;
 
-  for (unsigned int n = 0; n < pfParticleList.size(); ++n) {
-    const art::Ptr<recob::PFParticle> particle = pfParticleList.at(n);
+  for (unsigned int n = 0; n < hierarchy.size(); ++n) {
+    const art::Ptr<recob::PFParticle> particle = hierarchy.GetPFP(n);
 
     if(lar_pandora::LArPandoraHelper::IsNeutrino(particle)) {
       std::cout << "[UBXSecHelper] \t Creating TPC Object " << shower_v_v.size() << std::endl;
@@ -597,7 +652,7 @@ void UBXSecHelper::GetTPCObjects(lar_pandora::PFParticleVector pfParticleList,
       lar_pandora::ShowerVector shower_v;
       lar_pandora::PFParticleVector pfp_v;
 
-      CollectShowersAndPFP(pfParticleToShowerMap, pfParticleList, particle, pfp_v, shower_v);
+      CollectShowersAndPFP(hierarchy, pfParticleToShowerMap, particle, pfp_v, shower_v);
 
       pfp_v_v.emplace_back(pfp_v);
       shower_v_v.emplace_back(shower_v);
@@ -626,59 +681,25 @@ void UBXSecHelper::GetTPCObjects(lar_pandora::PFParticleVector pfParticleList,
 
 
 //______________________________________________________________________________________________________________________________________
-void UBXSecHelper::CollectShowersAndPFP(lar_pandora::PFParticlesToShowers pfParticleToShowerMap,
-                                          lar_pandora::PFParticleVector pfParticleList,
-                                          art::Ptr<recob::PFParticle> particle,
+void UBXSecHelper::CollectShowersAndPFP(ubxsec::PFPHierarchy const & hierarchy,
+                                          lar_pandora::PFParticlesToShowers const & pfParticleToShowerMap,
+                                          art::Ptr<recob::PFParticle> const & particle,
                                           lar_pandora::PFParticleVector &pfp_v,
                                           lar_pandora::ShowerVector &shower_v) {
 
-  pfp_v.emplace_back(particle);
-
-  lar_pandora::PFParticlesToShowers::const_iterator showerMapIter = pfParticleToShowerMap.find(particle);
-  if (showerMapIter != pfParticleToShowerMap.end()) {
-    lar_pandora::ShowerVector showers = showerMapIter->second;
-    std::cout << "[UBXSecHelper] \t PFP " << particle->Self() << " has " << showers.size() << " showers ass." << std::endl;
-    for (unsigned int shwr = 0; shwr < showers.size(); shwr++) {
-      shower_v.emplace_back(showers[shwr]);
-    }
-  }
-  const std::vector<size_t> &daughterIDs = particle->Daughters();
-  if(daughterIDs.size() == 0) return;
-  else {
-    for (unsigned int m = 0; m < daughterIDs.size(); ++m) {
-      const art::Ptr<recob::PFParticle> daughter = pfParticleList.at(daughterIDs.at(m));
-      CollectShowersAndPFP(pfParticleToShowerMap, pfParticleList, daughter, pfp_v, shower_v);
-    }
-  }
+  hierarchy.CollectPFPAndObjects(hierarchy.Index(particle), pfParticleToShowerMap, pfp_v, shower_v);
 
 }
 
 
 //______________________________________________________________________________________________________________________________________
-void UBXSecHelper::CollectTracksAndPFP(lar_pandora::PFParticlesToTracks pfParticleToTrackMap,
-                                          lar_pandora::PFParticleVector pfParticleList,
-                                          art::Ptr<recob::PFParticle> particle,
+void UBXSecHelper::CollectTracksAndPFP(ubxsec::PFPHierarchy const & hierarchy,
+                                          lar_pandora::PFParticlesToTracks const & pfParticleToTrackMap,
+                                          art::Ptr<recob::PFParticle> const & particle,
                                           lar_pandora::PFParticleVector &pfp_v,
                                           lar_pandora::TrackVector &track_v) {
 
-  pfp_v.emplace_back(particle);
-
-  lar_pandora::PFParticlesToTracks::const_iterator trackMapIter = pfParticleToTrackMap.find(particle);
-  if (trackMapIter != pfParticleToTrackMap.end()) {
-    lar_pandora::TrackVector tracks = trackMapIter->second;
-    std::cout << "[UBXSecHelper] \t PFP " << particle->Self() << " has " << tracks.size() << " tracks ass." << std::endl;
-    for (unsigned int trk = 0; trk < tracks.size(); trk++) {
-      track_v.emplace_back(tracks[trk]);
-    }
-  }
-  const std::vector<size_t> &daughterIDs = particle->Daughters();
-  if(daughterIDs.size() == 0) return;
-  else {
-    for (unsigned int m = 0; m < daughterIDs.size(); ++m) {
-      const art::Ptr<recob::PFParticle> daughter = pfParticleList.at(daughterIDs.at(m));
-      CollectTracksAndPFP(pfParticleToTrackMap, pfParticleList, daughter, pfp_v, track_v);
-    }
-  }
+  hierarchy.CollectPFPAndObjects(hierarchy.Index(particle), pfParticleToTrackMap, pfp_v, track_v);
 
 }
 
@@ -687,22 +708,15 @@ void UBXSecHelper::CollectTracksAndPFP(lar_pandora::PFParticlesToTracks pfPartic
 //______________________________________________________________________________________________________________________________________
 bool UBXSecHelper::InFV(double * nu_vertex_xyz){
 
-  double x = nu_vertex_xyz[0];
-  double y = nu_vertex_xyz[1];
-  double z = nu_vertex_xyz[2];
+  //This uses our current settings for the fiducial volume
+  return ubxsec::FiducialVolume::InDefaultFV(nu_vertex_xyz);
 
-  //This defines our current settings for the fiducial volume
-  double FVx = 256.35;
-  double FVy = 233;
-  double FVz = 1036.8;
-  double borderx = 10.;
-  double bordery = 20.;
-  double borderz = 10.;
-  //double cryoradius = 191.61;
-  //double cryoz = 1086.49 + 2*67.63;
+}
+
+//__________________________________________________________________________
+bool UBXSecHelper::InFV(const ubxsec::FiducialVolume & fv, double * nu_vertex_xyz){
 
-  if(x < (FVx - borderx) && (x > borderx) && (y < (FVy/2. - bordery)) && (y > (-FVy/2. + bordery)) && (z < (FVz - borderz)) && (z > borderz)) return true;
-  return false;
+  return fv.InFV(nu_vertex_xyz);
 
 }
 
@@ -846,40 +860,110 @@ void UBXSecHelper::GetNumberOfHitsPerPlane(art::Event const & e,
 
 }
 
+//______________________________________________________________________________
+bool UBXSecHelper::TrackPassesHitRequirment(ubxsec::PandoraEventCache const & cache,
+                                            art::Ptr<recob::Track> const & trk,
+                                            int nHitsReq) {
+
+  return cache.GetTrackHitCounts().PassesHitRequirement(trk.key(), nHitsReq);
+
+}
+
+//______________________________________________________________________________
+void UBXSecHelper::GetNumberOfHitsPerPlane(ubxsec::PandoraEventCache const & cache,
+                                              lar_pandora::TrackVector const & track_v,
+                                              int & nhits_u,
+                                              int & nhits_v,
+                                              int & nhits_w ) {
+
+  nhits_u = 0;
+  nhits_v = 0;
+  nhits_w = 0;
+
+  ubxsec::HitCountTable const & hit_counts = cache.GetTrackHitCounts();
+
+  // Loop over the tracks in this TPC Object
+  for (unsigned int t = 0; t < track_v.size(); t++) {
+
+    ubxsec::HitCounts const & counts = hit_counts.Get(track_v[t].key());
+    nhits_u += counts.n_hits[0];
+    nhits_v += counts.n_hits[1];
+    nhits_w += counts.n_hits[2];
+  }
+
+}
+
+//______________________________________________________________________________
+void UBXSecHelper::GetNumberOfHitsPerPlane(ubxsec::PandoraEventCache const & cache,
+                                              lar_pandora::ShowerVector const & shower_v,
+                                              int & nhits_u,
+                                              int & nhits_v,
+                                              int & nhits_w ) {
+
+  nhits_u = 0;
+  nhits_v = 0;
+  nhits_w = 0;
+
+  ubxsec::HitCountTable const & hit_counts = cache.GetShowerHitCounts();
+
+  // Loop over the showers in this TPC Object
+  for (unsigned int t = 0; t < shower_v.size(); t++) {
+
+    ubxsec::HitCounts const & counts = hit_counts.Get(shower_v[t].key());
+    nhits_u += counts.n_hits[0];
+    nhits_v += counts.n_hits[1];
+    nhits_w += counts.n_hits[2];
+  }
+
+}
+
 //_________________________________________________________________________________
 bool UBXSecHelper::IsCrossingTopBoundary(recob::Track track, int & vtx_ok){
 
+  return IsCrossingTopBoundary(ubxsec::FiducialVolume(), track, vtx_ok);
+
+}
+
+//_________________________________________________________________________________
+bool UBXSecHelper::IsCrossingTopBoundary(const ubxsec::FiducialVolume & fv, const recob::Track & track, int & vtx_ok){
+
   double vtx[3];
   vtx[0] = track.Vertex().X();
   vtx[1] = track.Vertex().Y();
   vtx[2] = track.Vertex().Z();
-  std::cout << "VTX X " <<vtx[0] << "Y " <<vtx[1] << "Z " <<vtx[2] << std::endl;
 
   double end[3];
   end[0] = track.End().X();
   end[1] = track.End().Y();
   end[2] = track.End().Z();
-  std::cout << "END X " <<end[0] << "Y " <<end[1] << "Z " <<end[2] << std::endl;
 
-  if ( InFV(vtx) && !InFV(end) && (end[1] > 233/2.-20)) {
-    std::cout << "Crossing top boundary, vertex is in FV" << std::endl;
-    vtx_ok = 0;
-    return true;
-  } else if (!InFV(vtx) && InFV(end) && (vtx[1] > 233/2.-20))  {
-    std::cout << "Crossing top boundary, end is in FV" << std::endl;
-    vtx_ok = 1;
-    return true;
-  }
-  else {
-    vtx_ok = -1;
-    return false;
-  }
+  return CrossingTopBoundary(fv, vtx, end, vtx_ok, std::cout);
+
+}
+
+//_________________________________________________________________________________
+bool UBXSecHelper::IsCrossingTopBoundary(const ubxsec::FiducialVolume & fv, const ubxsec::TrackSummaryTable & summaries, const art::Ptr<recob::Track> & track, int & vtx_ok, std::ostream & log){
+
+  TVector3 start_v = summaries.Start(track);
+  TVector3 end_v   = summaries.End(track);
+
+  double vtx[3] = {start_v.X(), start_v.Y(), start_v.Z()};
+  double end[3] = {end_v.X(),   end_v.Y(),   end_v.Z()};
+
+  return CrossingTopBoundary(fv, vtx, end, vtx_ok, log);
 
 }
 
 //_________________________________________________________________________________
 bool UBXSecHelper::IsCrossingBoundary(recob::Track track, int & vtx_ok){
 
+  return IsCrossingBoundary(ubxsec::FiducialVolume(), track, vtx_ok);
+
+}
+
+//_________________________________________________________________________________
+bool UBXSecHelper::IsCrossingBoundary(const ubxsec::FiducialVolume & fv, const recob::Track & track, int & vtx_ok){
+
   double vtx[3];
   vtx[0] = track.Vertex().X();
   vtx[1] = track.Vertex().Y();
@@ -890,17 +974,20 @@ bool UBXSecHelper::IsCrossingBoundary(recob::Track track, int & vtx_ok){
   end[1] = track.End().Y();
   end[2] = track.End().Z();
 
-  if ( InFV(vtx) && !InFV(end) ) {
-    vtx_ok = 0;
-    return true;
-  } else if (!InFV(vtx) && InFV(end))  {
-    vtx_ok = 1;
-    return true;
-  }
-  else {
-    vtx_ok = -1;
-    return false;
-  }
+  return CrossingBoundary(fv, vtx, end, vtx_ok);
+
+}
+
+//_________________________________________________________________________________
+bool UBXSecHelper::IsCrossingBoundary(const ubxsec::FiducialVolume & fv, const ubxsec::TrackSummaryTable & summaries, const art::Ptr<recob::Track> & track, int & vtx_ok){
+
+  TVector3 start_v = summaries.Start(track);
+  TVector3 end_v   = summaries.End(track);
+
+  double vtx[3] = {start_v.X(), start_v.Y(), start_v.Z()};
+  double end[3] = {end_v.X(),   end_v.Y(),   end_v.Z()};
+
+  return CrossingBoundary(fv, vtx, end, vtx_ok);
 
 }
 
@@ -936,107 +1023,72 @@ bool UBXSecHelper::GetLongestTrackFromTPCObj(lar_pandora::TrackVector track_v, r
 
 }
 
-
-
-
 //_________________________________________________________________________________
-bool UBXSecHelper::PointIsCloseToDeadRegion(double *reco_nu_vtx, int plane_no){
-
-  ::art::ServiceHandle<geo::Geometry> geo;
+bool UBXSecHelper::GetLongestTrackFromTPCObj(const ubxsec::TrackSummaryTable & summaries, const lar_pandora::TrackVector & track_v, art::Ptr<recob::Track> & out_track) {
 
-  // Get nearest channel
-  raw::ChannelID_t ch = geo->NearestChannel(reco_nu_vtx, plane_no);
-  //std::cout << "nearest channel is " << ch << std::endl;
+  // Same selection as above, lengths from the table
+  int length = -1;
+  int longest_track = -1;
+  for (unsigned int t = 0; t < track_v.size(); t++){
 
-  // Get channel status
-  const lariov::ChannelStatusProvider& chanFilt = art::ServiceHandle<lariov::ChannelStatusService>()->GetProvider();
-  //std::cout << "ch status " << chanFilt.Status(ch) << std::endl;
-  if( chanFilt.Status(ch) < 4) return true;
+    double l = summaries.Length(track_v[t]);
+    if (l > length){
 
-  // Now check close wires
-  for(unsigned int new_ch = ch - 5; new_ch < ch - 5 + 11; new_ch++){
-    //std::cout << "now trying with channel " << new_ch << std::endl;
-    if( new_ch < 0 || new_ch >= 8256) continue;
-    if( chanFilt.Status(new_ch) < 4 ) return true;
-  }
+      length = l;
+      longest_track = t;
 
-/*
-  double new_point_in_tpc[3];
-  for (int z_off = -5; z_off < 5; z_off += 2.5) {
-    new_point_in_tpc[0] = reco_nu_vtx[0];
-    new_point_in_tpc[1] = reco_nu_vtx[1];
-    new_point_in_tpc[2] = reco_nu_vtx[2] + z_off;
-    //std::cout << "trying with point " << new_point_in_tpc[0] << " " << new_point_in_tpc[1] << " " << new_point_in_tpc[2] << std::endl;
+    }
 
-    raw::ChannelID_t ch = geo->NearestChannel(new_point_in_tpc, 2);
-    if( chanFilt.Status(ch) < 4) return true;
   }
-*/
 
-  return false;
+  if (longest_track > -1){
+    out_track = track_v[longest_track];
+    return true;
+  } else {
+    return false;
+  }
 
 }
 
 
-//______________________________________________________________________________
-int UBXSecHelper::GetClosestPMT(double *charge_center) {
 
-  int pmt_id= -1;
 
-  ::art::ServiceHandle<geo::Geometry> geo;
-  double xyz[3];
-  double dist;
-  double min_dist = 1.e9;
-
-  for (size_t opch = 0; opch < 32; opch++) {
-    geo->OpDetGeoFromOpChannel(opch).GetCenter(xyz); 
-    dist = std::sqrt( (charge_center[0] - xyz[0])*(charge_center[0] - xyz[0]) +
-                      (charge_center[1] - xyz[1])*(charge_center[1] - xyz[1]) +
-                      (charge_center[2] - xyz[2])*(charge_center[2] - xyz[2]) );
-
-    if (dist < min_dist) {
-      min_dist = dist;
-      pmt_id = opch;
-    }        
-  }
-
-  return pmt_id;
-}
+//_________________________________________________________________________________
+raw::ChannelID_t UBXSecHelper::NearestChannel(double *point, int plane_no, FindDeadRegions & deadRegionsFinder){
 
+  // From the cached wire projection if available
+  const ubxsec::WireProjector & projector = deadRegionsFinder.GetWireProjector();
+  if (projector.Ready()) {
+    return projector.NearestChannel(plane_no, point[1], point[2]);
+  }
 
-//_______________________________________________________________________________
-double UBXSecHelper::GetFlashZCenter(std::vector<double> hypo_pe) {
+  ::art::ServiceHandle<geo::Geometry> geo;
+  return geo->NearestChannel(point, plane_no);
 
-  double Zcenter = 0.;
-  double totalPE = 0.;
-  double sumz = 0.;
+}
 
-  ::art::ServiceHandle<geo::Geometry> geo;
+//_________________________________________________________________________________
+bool UBXSecHelper::PointIsCloseToDeadRegion(double *reco_nu_vtx, int plane_no, FindDeadRegions & deadRegionsFinder, int window){
 
-  // opdet=>opchannel mapping
-  std::vector<size_t> opdet2opch(geo->NOpDets(),0);
-  for(size_t opch=0; opch<opdet2opch.size(); ++opch){
-    opdet2opch[geo->OpDetFromOpChannel(opch)] = opch;
-  }
+  raw::ChannelID_t ch = NearestChannel(reco_nu_vtx, plane_no, deadRegionsFinder);
 
-  for (unsigned int opdet = 0; opdet < hypo_pe.size(); opdet++) {
+  // Check the channel and the close ones on the same plane
+  return deadRegionsFinder.ChannelNearBadChannel(ch, window);
 
-    size_t opch = opdet2opch[opdet];
+}
 
-    // Get physical detector location for this opChannel
-    double PMTxyz[3];
-    geo->OpDetGeoFromOpChannel(opch).GetCenter(PMTxyz);
 
-    // Add up the position, weighting with PEs
-    sumz    += hypo_pe[opdet]*PMTxyz[2];
+//______________________________________________________________________________
+int UBXSecHelper::GetClosestPMT(double *charge_center) {
 
-    totalPE += hypo_pe[opdet];
-  }
+  return ubxsec::PMTTable::Instance().ClosestOpChannel(charge_center);
+}
 
-  Zcenter = sumz/totalPE;
 
-  return Zcenter;
+//_______________________________________________________________________________
+double UBXSecHelper::GetFlashZCenter(std::vector<double> hypo_pe) {
 
+  return ubxsec::PMTTable::Instance().FlashZCenterFromOpDet(hypo_pe);
 }
 
 
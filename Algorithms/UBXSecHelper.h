@@ -22,8 +22,21 @@
 #ifndef UBXSECHELPER_H
 #define UBXSECHELPER_H
 
+#include <iostream>
+
 #include "lardataobj/RecoBase/PFParticle.h"
 #include "larpandora/LArPandoraInterface/LArPandoraHelper.h"
+#include "larcoreobj/SimpleTypesAndConstants/RawTypes.h"
+
+#include "PandoraEventCache.h"
+#include "PFPHierarchy.h"
+#include "RecoTrueMatcher.h"
+#include "BackTrackerCache.h"
+#include "SimChannelBackTracker.h"
+#include "PMTTable.h"
+#include "FindDeadRegions.h"
+#include "FiducialVolume.h"
+#include "TrackSummaryTable.h"
 
 typedef std::map< art::Ptr<recob::PFParticle>, unsigned int > RecoParticleToNMatchedHits;
 typedef std::map< art::Ptr<simb::MCParticle>,  RecoParticleToNMatchedHits > ParticleMatchingMap;
@@ -39,6 +52,17 @@ namespace ubana {
   };            
 }
 
+namespace ubana {
+  /// A Pandora neutrino slice (TPC object): its PFPs with the tracks, showers and neutrino vertex associated
+  struct TPCObjectSlice {
+    art::Ptr<recob::PFParticle>   nu_pfp;    ///< The neutrino PFP at the top of the slice
+    lar_pandora::PFParticleVector pfp_v;     ///< All the PFPs in the slice, neutrino PFP first
+    lar_pandora::TrackVector      track_v;   ///< All the tracks associated to the PFPs in the slice
+    lar_pandora::ShowerVector     shower_v;  ///< All the showers associated to the PFPs in the slice
+    art::Ptr<recob::Vertex>       nu_vertex; ///< The neutrino vertex (null if not available)
+  };
+}
+
 class UBXSecHelper {
 
   public:
@@ -52,6 +76,26 @@ class UBXSecHelper {
    */
   static void GetTrackPurityAndEfficiency( lar_pandora::HitVector recoHits, double & trackPurity, double & trackEfficiency );
 
+  /**
+   *  @brief Gets purity and efficiency for a track (PFP, whatever), reading the BackTracker results from the cache
+   *
+   *  @param bt_cache the event BackTracker cache
+   *  @param recoHits the reconstructed hits of the track
+   *  @param trackPurity the output track (PFP, whatever) purity 
+   *  @param trackEfficiency the output track (PFP, whatever) efficiency
+   */
+  static void GetTrackPurityAndEfficiency( ubxsec::BackTrackerCache & bt_cache, lar_pandora::HitVector const & recoHits, double & trackPurity, double & trackEfficiency );
+
+  /**
+   *  @brief Gets purity and efficiency for a track (PFP, whatever), backtracking the hits from the SimChannels
+   *
+   *  @param bt the event SimChannel backtracker
+   *  @param recoHits the reconstructed hits of the track
+   *  @param trackPurity the output track (PFP, whatever) purity 
+   *  @param trackEfficiency the output track (PFP, whatever) efficiency
+   */
+  static void GetTrackPurityAndEfficiency( ubxsec::SimChannelBackTracker const & bt, lar_pandora::HitVector const & recoHits, double & trackPurity, double & trackEfficiency );
+
     /**
    *  @brief Perform matching between true and reconstructed particles
    *
@@ -120,12 +164,29 @@ class UBXSecHelper {
    *  @param _particleLabel the PFP producer module
    *  @param pfp_v_v output, a vector of vector of PFP (a vector of TPC objects)
    *  @param track_v_v output, a vector of vector of tracks (a vector of TPC objects)   */
-  static void GetTPCObjects(lar_pandora::PFParticleVector pfParticleList, lar_pandora::PFParticlesToTracks pfParticleToTrackMap, lar_pandora::PFParticlesToVertices  pfParticleToVertexMap, std::vector<lar_pandora::PFParticleVector> & pfp_v_v, std::vector<lar_pandora::TrackVector> & track_v_v);
+  static void GetTPCObjects(lar_pandora::PFParticleVector const & pfParticleList, lar_pandora::PFParticlesToTracks const & pfParticleToTrackMap, lar_pandora::PFParticlesToVertices const & pfParticleToVertexMap, std::vector<lar_pandora::PFParticleVector> & pfp_v_v, std::vector<lar_pandora::TrackVector> & track_v_v);
+
+  /**
+   *  @brief Constructs TPC objects using Pandora PFP slices
+   *
+   *  @param hierarchy the PFP hierarchy
+   *  @param pfParticleToTrackMap map from PFP to tracks
+   *  @param pfParticleToVertexMap map from PFP to vertices
+   *  @param pfp_v_v output, a vector of vector of PFP (a vector of TPC objects)
+   *  @param track_v_v output, a vector of vector of tracks (a vector of TPC objects)   */
+  static void GetTPCObjects(ubxsec::PFPHierarchy const & hierarchy, lar_pandora::PFParticlesToTracks const & pfParticleToTrackMap, lar_pandora::PFParticlesToVertices const & pfParticleToVertexMap, std::vector<lar_pandora::PFParticleVector> & pfp_v_v, std::vector<lar_pandora::TrackVector> & track_v_v);
+
+  /**
+   *  @brief Constructs TPC objects using Pandora PFP slices, walking each slice once and collecting PFPs, tracks, showers and vertex
+   *
+   *  @param cache the Pandora products for this event
+   *  @param slice_v output, a vector of TPC objects */
+  static void GetTPCObjects(ubxsec::PandoraEventCache const & cache, std::vector<ubana::TPCObjectSlice> & slice_v);
 
   /**
    *  @brief Gets all the tracks and PFP for a single Pandora slice
    *
-   *  @param pfParticleList the list of PFP
+   *  @param hierarchy the PFP hierarchy
    *  @param pfParticleToTrackMap map from PFP to tracks
    *  @param particle the PFP
    *  @param pfp_v output, a vector of PFP (the TPC object)
@@ -167,19 +228,29 @@ class UBXSecHelper {
    *  @param _particleLabel the PFP producer module
    *  @param pfp_v_v output, a vector of vector of PFP (a vector of TPC objects)
    *  @param shower_v_v output, a vector of vector of tracks (a vector of TPC objects)   */
-  static void GetTPCObjects(lar_pandora::PFParticleVector pfParticleList, lar_pandora::PFParticlesToShowers pfParticleToShowerMap, lar_pandora::PFParticlesToVertices  pfParticleToVertexMap, std::vector<lar_pandora::PFParticleVector> & pfp_v_v, std::vector<lar_pandora::ShowerVector> & shower_v_v);
+  static void GetTPCObjects(lar_pandora::PFParticleVector const & pfParticleList, lar_pandora::PFParticlesToShowers const & pfParticleToShowerMap, lar_pandora::PFParticlesToVertices const & pfParticleToVertexMap, std::vector<lar_pandora::PFParticleVector> & pfp_v_v, std::vector<lar_pandora::ShowerVector> & shower_v_v);
+
+  /**
+   *  @brief Constructs TPC objects using Pandora PFP slices
+   *
+   *  @param hierarchy the PFP hierarchy
+   *  @param pfParticleToShowerMap map from PFP to showers
+   *  @param pfParticleToVertexMap map from PFP to vertices
+   *  @param pfp_v_v output, a vector of vector of PFP (a vector of TPC objects)
+   *  @param shower_v_v output, a vector of vector of showers (a vector of TPC objects)   */
+  static void GetTPCObjects(ubxsec::PFPHierarchy const & hierarchy, lar_pandora::PFParticlesToShowers const & pfParticleToShowerMap, lar_pandora::PFParticlesToVertices const & pfParticleToVertexMap, std::vector<lar_pandora::PFParticleVector> & pfp_v_v, std::vector<lar_pandora::ShowerVector> & shower_v_v);
 
   /**
    *  @brief Gets all the tracks and PFP for a single Pandora slice
    *
-   *  @param pfParticleList the list of PFP
+   *  @param hierarchy the PFP hierarchy
    *  @param pfParticleToShowerMap map from PFP to showers
    *  @param particle the PFP
    *  @param pfp_v output, a vector of PFP (the TPC object)
    *  @param shower_v output, a vector of showers (the TPC object)   */
 
 
-  static void CollectTracksAndPFP(lar_pandora::PFParticlesToTracks pfParticleToTrackMap, lar_pandora::PFParticleVector pfParticleList, art::Ptr<recob::PFParticle> particle, lar_pandora::PFParticleVector &pfp_v, lar_pandora::TrackVector &track_v);
+  static void CollectTracksAndPFP(ubxsec::PFPHierarchy const & hierarchy, lar_pandora::PFParticlesToTracks const & pfParticleToTrackMap, art::Ptr<recob::PFParticle> const & particle, lar_pandora::PFParticleVector &pfp_v, lar_pandora::TrackVector &track_v);
 
   /**
    *  @brief Returns the nu reco vertex from a TPC object
@@ -189,7 +260,7 @@ class UBXSecHelper {
    *  @param pfp_v the TPC object (vector of PFP)
    *  @param reco_nu_vtx output, the nu vertex (three dimensional array: x, y, z) */
 
-  static void CollectShowersAndPFP(lar_pandora::PFParticlesToShowers pfParticleToShowerMap, lar_pandora::PFParticleVector pfParticleList, art::Ptr<recob::PFParticle> particle, lar_pandora::PFParticleVector &pfp_v, lar_pandora::ShowerVector &shower_v);
+  static void CollectShowersAndPFP(ubxsec::PFPHierarchy const & hierarchy, lar_pandora::PFParticlesToShowers const & pfParticleToShowerMap, art::Ptr<recob::PFParticle> const & particle, lar_pandora::PFParticleVector &pfp_v, lar_pandora::ShowerVector &shower_v);
 
   /**
    *  @brief Returns the nu reco vertex from a TPC object
@@ -221,6 +292,13 @@ class UBXSecHelper {
    *  @param nu_vertex_xyz a 3 dimensional array */
   static bool InFV(double * nu_vertex_xyz);
 
+  /**
+   *  @brief Returns true if the point passed is in the fiducial volume
+   *
+   *  @param fv the fiducial volume
+   *  @param nu_vertex_xyz a 3 dimensional array */
+  static bool InFV(const ubxsec::FiducialVolume & fv, double * nu_vertex_xyz);
+
   /**
    *  @brief Returns the origin of the TPC object (neutrino/cosmic/mixed)
    *
@@ -259,6 +337,34 @@ class UBXSecHelper {
    *  @param nHitsReq the minimum number of hits */
   static bool TrackPassesHitRequirment(art::Event const & e, std::string _particleLabel, art::Ptr<recob::Track> trk, int nHitsReq);
 
+  /**
+   *  @brief Returns number of hits on each plane for a TPC obj, taking the hits from the event cache
+   *
+   *  @param cache the Pandora products for this event
+   *  @param track_v the TPC object (vector of tracks)
+   *  @param nhits_u number of hits in the U plane
+   *  @param nhits_v number of hits in the V plane
+   *  @param nhits_w number of hits in the W plane  */
+  static void GetNumberOfHitsPerPlane(ubxsec::PandoraEventCache const & cache, lar_pandora::TrackVector const & track_v, int & nhits_u, int & nhits_v, int & nhits_w);
+
+  /**
+   *  @brief Returns number of hits on each plane for a TPC obj, taking the hits from the event cache
+   *
+   *  @param cache the Pandora products for this event
+   *  @param shower_v the TPC object (vector of showers)
+   *  @param nhits_u number of hits in the U plane
+   *  @param nhits_v number of hits in the V plane
+   *  @param nhits_w number of hits in the W plane  */
+  static void GetNumberOfHitsPerPlane(ubxsec::PandoraEventCache const & cache, lar_pandora::ShowerVector const & shower_v, int & nhits_u, int & nhits_v, int & nhits_w);
+
+  /**
+   *  @brief Returns true if the track passes a minimum hit requirment in at least one plane
+   *
+   *  @param cache the Pandora products for this event
+   *  @param trk the recob::Track
+   *  @param nHitsReq the minimum number of hits */
+  static bool TrackPassesHitRequirment(ubxsec::PandoraEventCache const & cache, art::Ptr<recob::Track> const & trk, int nHitsReq);
+
   /**
    *  @brief Returns true if the track is crossing the FV border
    *
@@ -268,6 +374,23 @@ class UBXSecHelper {
 
   static bool IsCrossingBoundary(recob::Track track, int & vtx_ok);
 
+  /**
+   *  @brief Returns true if the track is crossing the border of the passed FV
+   *
+   *  @param fv the fiducial volume
+   *  @param track the track
+   *  @param vtx_ok is 0 if the vtx is in the FV, 1 otherwise  */
+  static bool IsCrossingBoundary(const ubxsec::FiducialVolume & fv, const recob::Track & track, int & vtx_ok);
+
+  /**
+   *  @brief Returns true if the track is crossing the border of the passed FV, end points from the track table
+   *
+   *  @param fv the fiducial volume
+   *  @param summaries the track table
+   *  @param track the track
+   *  @param vtx_ok is 0 if the vtx is in the FV, 1 otherwise  */
+  static bool IsCrossingBoundary(const ubxsec::FiducialVolume & fv, const ubxsec::TrackSummaryTable & summaries, const art::Ptr<recob::Track> & track, int & vtx_ok);
+
   /**
    *  @brief Returns true if the track is crossing the FV border from the TOP
    *
@@ -275,6 +398,24 @@ class UBXSecHelper {
    *  @param vtx_ok is 0 if the vtx is in the FV, 1 otherwise  */
   static bool IsCrossingTopBoundary(recob::Track track, int & vtx_ok);
 
+  /**
+   *  @brief Returns true if the track is crossing the border of the passed FV from the TOP
+   *
+   *  @param fv the fiducial volume
+   *  @param track the track
+   *  @param vtx_ok is 0 if the vtx is in the FV, 1 otherwise  */
+  static bool IsCrossingTopBoundary(const ubxsec::FiducialVolume & fv, const recob::Track & track, int & vtx_ok);
+
+  /**
+   *  @brief Returns true if the track is crossing the border of the passed FV from the TOP, end points from the track table
+   *
+   *  @param fv the fiducial volume
+   *  @param summaries the track table
+   *  @param track the track
+   *  @param vtx_ok is 0 if the vtx is in the FV, 1 otherwise
+   *  @param log where the track end points are printed  */
+  static bool IsCrossingTopBoundary(const ubxsec::FiducialVolume & fv, const ubxsec::TrackSummaryTable & summaries, const art::Ptr<recob::Track> & track, int & vtx_ok, std::ostream & log = std::cout);
+
   /**
    *  @brief Gets the longest track from a TPC object, returns false if there are no tracks in the TPC object
    *
@@ -282,12 +423,33 @@ class UBXSecHelper {
    *  @param out_track the longest track  */
   static bool GetLongestTrackFromTPCObj(lar_pandora::TrackVector track_v, recob::Track & out_track);
 
+  /**
+   *  @brief Gets the longest track from a TPC object, lengths from the track table
+   *
+   *  @param summaries the track table
+   *  @param track_v the TPC object (vector of tracks)
+   *  @param out_track the longest track  */
+  static bool GetLongestTrackFromTPCObj(const ubxsec::TrackSummaryTable & summaries, const lar_pandora::TrackVector & track_v, art::Ptr<recob::Track> & out_track);
+
+  /**
+   *  @brief Returns the channel closest to the point on the passed plane
+   *
+   *  From the wire projection of the dead region finder, or from the
+   *  Geometry service if the projection is not available.
+   *
+   *  @param point the 3D point (c array)
+   *  @param plane_no the plane
+   *  @param deadRegionsFinder the dead region finder holding the wire projection  */
+  static raw::ChannelID_t NearestChannel(double *point, int plane_no, FindDeadRegions & deadRegionsFinder);
+
   /**
    *  @brief Returns true if the point passed is close to a dead region
    *
    *  @param reco_nu_vtx the point to check
-   *  @param plane_no the plane we want to check with  */
-  static bool PointIsCloseToDeadRegion(double *reco_nu_vtx, int plane_no);
+   *  @param plane_no the plane we want to check with
+   *  @param deadRegionsFinder the dead region finder holding the channel statuses
+   *  @param window the number of channels to check on each side of the closest one  */
+  static bool PointIsCloseToDeadRegion(double *reco_nu_vtx, int plane_no, FindDeadRegions & deadRegionsFinder, int window = 5);
 
   /**
    *  @brief Returns the clostes opchannel to the 3D specified point
@@ -71,36 +71,30 @@ namespace ubxsec {
     // Get vertex location
     _vtx.XYZ(xyz);
 
-    keep_track.clear();
     track_dir.clear();
 
+    // Without a table, every query falls back to the track itself
+    static const TrackSummaryTable no_summaries;
+    const TrackSummaryTable & summaries = (_summaries ? *_summaries : no_summaries);
+
     // Loop over tracks 
     for (size_t t = 0; t < _track_v.size(); t++) {
-      start = _track_v[t]->Vertex();
-      end   = _track_v[t]->End();
+      start = summaries.Start(_track_v[t]);
+      end   = summaries.End(_track_v[t]);
       
       dist = GetDistance(xyz, start);
       if (dist < _max_distance){
-        keep_track.emplace_back(*(_track_v[t]));
-        track_dir.emplace_back(_track_v[t]->VertexDirection());
+        track_dir.emplace_back(summaries.StartDirection(_track_v[t]));
         continue;
       }
 
       dist = GetDistance(xyz, end);
       if (dist < _max_distance){
-        keep_track.emplace_back(*(_track_v[t]));
-        track_dir.emplace_back(-(_track_v[t]->EndDirection()));
+        track_dir.emplace_back(-(summaries.EndDirection(_track_v[t])));
       }  
     }
 
-    // Sort tracks by length
-    std::sort(keep_track.begin(), keep_track.end(),
-              [](recob::Track a, recob::Track b) -> bool
-              {
-                return a.Length() > b.Length();
-              });
-
-    if (keep_track.size() < 2) return -9999;
+    if (track_dir.size() < 2) return -9999;
 
     // Calculate angle between two longest tracks
     return track_dir[0].Angle(track_dir[1]);  
@@ -0,0 +1,128 @@
+#ifndef WIREPROJECTOR_CXX
+#define WIREPROJECTOR_CXX
+
+#include "WireProjector.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace ubxsec {
+
+  bool WireProjector::Configure(std::vector<unsigned int> const& ch_wire,
+                                std::vector<float> const& ch_sy, std::vector<float> const& ch_sz,
+                                std::vector<float> const& ch_ey, std::vector<float> const& ch_ez,
+                                const int plane_first_ch[4])
+  {
+    _ready = false;
+
+    size_t n_ch = plane_first_ch[3];
+    if (ch_wire.size() < n_ch || ch_sy.size() < n_ch || ch_sz.size() < n_ch ||
+        ch_ey.size() < n_ch || ch_ez.size() < n_ch) {
+      std::cerr << "[WireProjector] Expected " << n_ch << " channels, got " << ch_wire.size() << "." << std::endl;
+      return false;
+    }
+
+    for (int plane = 0; plane < 3; plane++) {
+
+      PlaneProjection & p = _planes[plane];
+      p = PlaneProjection();
+
+      unsigned int first = plane_first_ch[plane];
+      unsigned int n_wires = plane_first_ch[plane+1] - plane_first_ch[plane];
+
+      // Wires have to be numbered along the channels
+      for (unsigned int w = 0; w < n_wires; w++) {
+        if (ch_wire[first + w] != w) {
+          std::cerr << "[WireProjector] Channel " << first + w << " is not wire " << w
+                    << " on plane " << plane << "." << std::endl;
+          return false;
+        }
+      }
+      if (n_wires < 2) return false;
+
+      // All the wires are parallel, take the direction from the longest one
+      double dy = 0., dz = 0., length = 0.;
+      for (unsigned int ch = first; ch < first + n_wires; ch++) {
+        double l = std::hypot(ch_ey[ch] - ch_sy[ch], ch_ez[ch] - ch_sz[ch]);
+        if (l > length) {
+          dy = ch_ey[ch] - ch_sy[ch];
+          dz = ch_ez[ch] - ch_sz[ch];
+          length = l;
+        }
+      }
+      if (length <= 0.) return false;
+
+      // Normal to the wires, pointing towards increasing wire numbers
+      double n_y = -dz / length;
+      double n_z =  dy / length;
+
+      unsigned int last = first + n_wires - 1;
+      double c_first = 0.5 * ((ch_sy[first] + ch_ey[first]) * n_y + (ch_sz[first] + ch_ez[first]) * n_z);
+      double c_last  = 0.5 * ((ch_sy[last]  + ch_ey[last])  * n_y + (ch_sz[last]  + ch_ez[last])  * n_z);
+      if (c_last < c_first) {
+        n_y = -n_y;
+        n_z = -n_z;
+        c_first = -c_first;
+        c_last  = -c_last;
+      }
+
+      double pitch = (c_last - c_first) / (n_wires - 1);
+      if (pitch <= 0.) return false;
+
+      p.coeff_y  = n_y / pitch;
+      p.coeff_z  = n_z / pitch;
+      p.coeff_0  = -c_first / pitch;
+      p.pitch    = pitch;
+      p.n_wires  = n_wires;
+      p.first_ch = first;
+    }
+
+    _ready = true;
+
+    return true;
+  }
+
+  //___________________________________________________________________________________________________
+  void WireProjector::WireCoordinates(int plane, size_t n, float const* y, float const* z, float* wire) const
+  {
+    const float coeff_y = _planes[plane].coeff_y;
+    const float coeff_z = _planes[plane].coeff_z;
+    const float coeff_0 = _planes[plane].coeff_0;
+
+    // No branches and no aliasing between inputs and output: vectorised at -O2/-O3
+    for (size_t i = 0; i < n; i++) {
+      wire[i] = y[i] * coeff_y + z[i] * coeff_z + coeff_0;
+    }
+  }
+
+  //___________________________________________________________________________________________________
+  void WireProjector::WireCoordinates(int plane, std::vector<float> const& y, std::vector<float> const& z, std::vector<float> & wire) const
+  {
+    size_t n = std::min(y.size(), z.size());
+    wire.resize(n);
+    WireCoordinates(plane, n, y.data(), z.data(), wire.data());
+  }
+
+  //___________________________________________________________________________________________________
+  unsigned int WireProjector::NearestWire(int plane, float y, float z) const
+  {
+    unsigned int n_wires = _planes[plane].n_wires;
+    if (n_wires == 0) return 0;
+
+    float w = WireCoordinate(plane, y, z);
+
+    // Also catches NaN
+    if (!(w > 0.)) return 0;
+    if (w >= n_wires - 1) return n_wires - 1;
+
+    return static_cast<unsigned int>(w + 0.5);
+  }
+
+  //___________________________________________________________________________________________________
+  unsigned int WireProjector::NearestChannel(int plane, float y, float z) const
+  {
+    return _planes[plane].first_ch + NearestWire(plane, y, z);
+  }
+}
+
+#endif
@@ -0,0 +1,109 @@
+/**
+ * \file WireProjector.h
+ *
+ * \ingroup UBXSec
+ *
+ * \brief Projects (y,z) points to fractional wire numbers on the three planes
+ *
+ * @author Marco Del Tutto
+ */
+
+/** \addtogroup UBXSec
+
+    @{*/
+
+#ifndef WIREPROJECTOR_H
+#define WIREPROJECTOR_H
+
+#include <iostream>
+#include <vector>
+
+namespace ubxsec {
+
+  /**
+   * All the wires of a plane are parallel and equally spaced, so the
+   * fractional wire number of a point is a linear function of y and z:
+   *
+   *   wire = y * coeff_y + z * coeff_z + coeff_0
+   *
+   * The three coefficients of each plane are extracted once from the wire
+   * end points, then batches of points are projected with a loop that the
+   * compiler can vectorise.
+   */
+  class WireProjector {
+
+  public:
+
+    WireProjector() = default;
+
+    /**
+     *  @brief Extracts the projection of each plane from the wire end points of all the channels
+     *
+     *  @param ch_wire the wire number of each channel
+     *  @param ch_sy the wire start y of each channel
+     *  @param ch_sz the wire start z of each channel
+     *  @param ch_ey the wire end y of each channel
+     *  @param ch_ez the wire end z of each channel
+     *  @param plane_first_ch the first channel of each plane, plus the total number of channels
+     *
+     *  @return false if the wires of a plane are not usable (the projector is then not ready)
+     */
+    bool Configure(std::vector<unsigned int> const& ch_wire,
+                   std::vector<float> const& ch_sy, std::vector<float> const& ch_sz,
+                   std::vector<float> const& ch_ey, std::vector<float> const& ch_ez,
+                   const int plane_first_ch[4]);
+
+    /// Returns true if the projection of all the planes is available
+    bool Ready() const { return _ready; }
+
+    /// Returns the number of wires on a plane
+    unsigned int NWires(int plane) const { return _planes[plane].n_wires; }
+
+    /// Returns the wire pitch of a plane (cm)
+    float Pitch(int plane) const { return _planes[plane].pitch; }
+
+    /// Returns the fractional wire number of a point, not clamped to the plane
+    float WireCoordinate(int plane, float y, float z) const
+    {
+      PlaneProjection const& p = _planes[plane];
+      return y * p.coeff_y + z * p.coeff_z + p.coeff_0;
+    }
+
+    /**
+     *  @brief Batch version of WireCoordinate
+     *
+     *  @param plane the plane
+     *  @param n the number of points
+     *  @param y the y coordinates of the points
+     *  @param z the z coordinates of the points
+     *  @param wire output, the fractional wire number of each point (n entries)
+     */
+    void WireCoordinates(int plane, size_t n, float const* y, float const* z, float* wire) const;
+
+    /// Same as above, resizes the output
+    void WireCoordinates(int plane, std::vector<float> const& y, std::vector<float> const& z, std::vector<float> & wire) const;
+
+    /// Returns the wire closest to a point, points outside the plane go to the first or last wire
+    unsigned int NearestWire(int plane, float y, float z) const;
+
+    /// Returns the channel of the wire closest to a point, points outside the plane go to the first or last wire
+    unsigned int NearestChannel(int plane, float y, float z) const;
+
+  private:
+
+    struct PlaneProjection {
+      float coeff_y = 0.;          ///< Wire number per cm along y
+      float coeff_z = 0.;          ///< Wire number per cm along z
+      float coeff_0 = 0.;          ///< Wire number at y = z = 0
+      float pitch = 0.;            ///< Wire pitch (cm)
+      unsigned int n_wires = 0;    ///< Number of wires on the plane
+      unsigned int first_ch = 0;   ///< Channel of wire 0
+    };
+
+    PlaneProjection _planes[3];
+    bool _ready = false;
+  };
+}
+
+#endif
+/** @} */ // end of doxygen group
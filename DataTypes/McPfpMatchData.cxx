@@ -0,0 +1,39 @@
+#include "McPfpMatchData.h"
+
+namespace ubana {
+
+  McPfpMatchData::McPfpMatchData() {
+    fNMatchedHits = -9999;
+    fNPFPHits     = -9999;
+    fNMCPHits     = -9999;
+  }
+
+  McPfpMatchData::McPfpMatchData(int n_matched_hits, int n_pfp_hits, int n_mcp_hits) {
+    fNMatchedHits = n_matched_hits;
+    fNPFPHits     = n_pfp_hits;
+    fNMCPHits     = n_mcp_hits;
+  }
+ 
+  McPfpMatchData::~McPfpMatchData(){
+  }
+
+  // Setter methoths
+  void McPfpMatchData::SetNMatchedHits (int n) { this->fNMatchedHits = n; }
+  void McPfpMatchData::SetNPFPHits     (int n) { this->fNPFPHits = n;     }
+  void McPfpMatchData::SetNMCPHits     (int n) { this->fNMCPHits = n;     }
+
+  // Getter methods
+  const int & McPfpMatchData::GetNMatchedHits() const { return this->fNMatchedHits; }
+  const int & McPfpMatchData::GetNPFPHits()     const { return this->fNPFPHits;     }
+  const int & McPfpMatchData::GetNMCPHits()     const { return this->fNMCPHits;     }
+
+  double McPfpMatchData::GetPurity() const {
+    if (fNPFPHits <= 0) return -9999;
+    return (double)fNMatchedHits / (double)fNPFPHits;
+  }
+
+  double McPfpMatchData::GetCompleteness() const {
+    if (fNMCPHits <= 0) return -9999;
+    return (double)fNMatchedHits / (double)fNMCPHits;
+  }
+}
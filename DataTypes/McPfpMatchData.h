@@ -0,0 +1,58 @@
+/**
+ * \class ubana::McPfpMatchData
+ *
+ * \ingroup UBXSec
+ *
+ * \brief Data product to store the hit counts of an MCParticle to PFParticle match
+ * 
+ *
+ * \author $Author: Marco Del Tutto<marco.deltutto@physics.ox.ac.uk> $
+ *
+ * \version $Revision: 1.0 $
+ *
+ * \date $Date: 2017/03/02 $
+ *
+ * Contact: marco.deltutto@physics.ox.ac.uk
+ *
+ * Created on: Friday, June 02, 2017 at 11:12:43
+ *
+ */
+
+#ifndef McPfpMatchData_h
+#define McPfpMatchData_h
+
+namespace ubana {
+
+  class McPfpMatchData {
+
+  public:
+
+    McPfpMatchData();
+    McPfpMatchData(int n_matched_hits, int n_pfp_hits, int n_mcp_hits);
+    virtual ~McPfpMatchData();
+
+    // Setter methods
+    void SetNMatchedHits(int);
+    void SetNPFPHits(int);
+    void SetNMCPHits(int);
+
+    // Getter methods
+    const int & GetNMatchedHits() const;
+    const int & GetNPFPHits()     const;
+    const int & GetNMCPHits()     const;
+
+    // Matched hits over the PFParticle hits
+    double GetPurity()            const;
+    // Matched hits over the MCParticle hits
+    double GetCompleteness()      const;
+
+  private:
+
+    int fNMatchedHits;  ///< Hits shared by the MCParticle and the PFParticle
+    int fNPFPHits;      ///< Hits of the PFParticle
+    int fNMCPHits;      ///< Hits of the MCParticle
+
+ };
+}
+
+#endif /* McPfpMatchData_h */
@@ -6,9 +6,11 @@
 #include "lardataobj/RecoBase/Track.h"
 #include "lardataobj/RecoBase/PFParticle.h"
 #include "lardataobj/AnalysisBase/FlashMatch.h"
+#include "nusimdata/SimulationBase/MCParticle.h"
 
 #include "uboone/UBXSec/DataTypes/FlashMatch.h"
 #include "uboone/UBXSec/DataTypes/TPCObject.h"
+#include "uboone/UBXSec/DataTypes/McPfpMatchData.h"
 #include <vector>
 
 template class art::Assns<anab::FlashMatch,recob::PFParticle>;
@@ -45,3 +47,13 @@ template class art::Wrapper<art::Assns<recob::PFParticle, ubana::TPCObject >>;
 template class art::Wrapper<art::Assns<ubana::FlashMatch,ubana::TPCObject,void> >;
 template class art::Wrapper<art::Assns<ubana::TPCObject,ubana::FlashMatch,void> >;
 
+
+
+
+template class std::vector<ubana::McPfpMatchData>;
+
+template class art::Assns<simb::MCParticle,recob::PFParticle,ubana::McPfpMatchData>;
+template class art::Assns<recob::PFParticle,simb::MCParticle,ubana::McPfpMatchData>;
+
+template class art::Wrapper<art::Assns<simb::MCParticle,recob::PFParticle,ubana::McPfpMatchData> >;
+template class art::Wrapper<art::Assns<recob::PFParticle,simb::MCParticle,ubana::McPfpMatchData> >;
@@ -29,6 +29,7 @@
 #include "lardataobj/AnalysisBase/CosmicTag.h"
 #include "lardata/Utilities/AssociationUtil.h"
 #include "uboone/RawData/utils/ubdaqSoftwareTriggerData.h"
+#include "uboone/UBXSec/Algorithms/AsyncTreeWriter.h"
 
 #include "TVector3.h"
 #include "TTree.h"
@@ -54,6 +55,7 @@ public:
 
   // Required functions.
   void produce(art::Event & e) override;
+  void endJob() override;
 
 private:
 
@@ -84,6 +86,8 @@ private:
   const std::vector<float> endPt2 = {-9999., -9999., -9999.};
 
   //std::ofstream _csvfile;
+  bool _async_tree_writing;  ///< If true, the tree is filled on a background thread
+  ubxsec::AsyncTreeFiller _tree_filler;
   TTree* _tree1;
   int _run, _subrun, _event;
   bool _sw_trigger;
@@ -115,6 +119,9 @@ ACPTTagger::ACPTTagger(fhicl::ParameterSet const & p)
   _pe_min          = p.get<double> ("PEMin", 0);
   _debug           = p.get<bool> ("Debug", true);
 
+  _async_tree_writing = p.get<bool> ("AsyncTreeWriting", false);
+  if (_async_tree_writing) ubxsec::EnableROOTThreadSafety();
+
   //_csvfile.open ("acpt.csv", std::ofstream::out | std::ofstream::trunc);
   //_csvfile << "trk_x_up,trk_x_down,fls_time" << std::endl;
 
@@ -141,6 +148,7 @@ ACPTTagger::ACPTTagger(fhicl::ParameterSet const & p)
   _tree1->Branch("dz_u_cathode",  "std::vector<double>", &_dz_u_cathode);
   _tree1->Branch("dt_d_cathode",  "std::vector<double>", &_dt_d_cathode);
   _tree1->Branch("dz_d_cathode",  "std::vector<double>", &_dz_d_cathode);
+  _tree_filler.Init(_tree1, _async_tree_writing);
 
   produces< std::vector<anab::CosmicTag>>();
   produces< art::Assns<anab::CosmicTag,   recob::Track>>();
@@ -149,6 +157,8 @@ ACPTTagger::ACPTTagger(fhicl::ParameterSet const & p)
 
 void ACPTTagger::produce(art::Event & e)
 {
+  // The tree variables may still be read by the previous event fill
+  _tree_filler.Wait();
 
   _run    = e.id().run();
   _subrun = e.id().subRun();
@@ -304,7 +314,15 @@ void ACPTTagger::produce(art::Event & e)
   e.put(std::move(assnOutCosmicTagTrack));
   e.put(std::move(assnOutCosmicTagPFParticle));
 
-   _tree1->Fill();
+  _tree_filler.Fill();
+}
+
+
+
+//___________________________________________________________________________________________________
+void ACPTTagger::endJob() {
+
+  _tree_filler.Wait();
 }
 
 
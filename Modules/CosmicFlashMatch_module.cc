@@ -45,6 +45,7 @@
 #include "uboone/LLSelectionTool/OpT0Finder/Algorithms/PhotonLibHypothesis.h"
 
 #include "uboone/UBXSec/Algorithms/UBXSecHelper.h"
+#include "uboone/UBXSec/Algorithms/AsyncTreeWriter.h"
 
 #include "TTree.h"
 
@@ -65,14 +66,13 @@ public:
   CosmicFlashMatch & operator = (CosmicFlashMatch const &) = delete;
   CosmicFlashMatch & operator = (CosmicFlashMatch &&) = delete;
 
-  void GetTPCObjects(lar_pandora::PFParticleVector, lar_pandora::PFParticlesToTracks, lar_pandora::PFParticlesToVertices, std::vector<lar_pandora::PFParticleVector> &, std::vector<lar_pandora::TrackVector> &);
   flashana::QCluster_t GetQCluster(std::vector<art::Ptr<recob::Track>>);
-  void CollectTracksAndPFP(lar_pandora::PFParticlesToTracks, lar_pandora::PFParticleVector, art::Ptr<recob::PFParticle>,  lar_pandora::PFParticleVector &, lar_pandora::TrackVector &);
   int  GetTrajectory(std::vector<art::Ptr<recob::Track>>, ::geoalgo::Trajectory &);
   flashana::Flash_t Trial(std::vector<art::Ptr<recob::Track>> track_v, flashana::Flash_t flashBeam, double & _chi2, double & _ll); 
 
   // Required functions.
   void produce(art::Event & e) override;
+  void endJob() override;
 
 private:
   std::string _particleLabel;          ///<
@@ -90,6 +90,8 @@ private:
   std::vector<double>    _xfixed_hypo_spec;
   double _xfixed_chi2, _xfixed_ll;
 
+  bool _async_tree_writing;  ///< If true, the tree is filled on a background thread
+  ubxsec::AsyncTreeFiller _tree_filler;
   TTree* _tree1;
   int _run, _subrun, _event, _matchid, _flashid;
   std::vector<double>               _score, _t0;
@@ -109,6 +111,8 @@ CosmicFlashMatch::CosmicFlashMatch(fhicl::ParameterSet const & p)
   _opflash_producer_cosmic = p.get<std::string>("CosmicOpFlashProducer", "simpleFlashCosmic");
   _flash_trange_start      = p.get<double>     ("FlashVetoTimeStart",    -1000000);
   _flash_trange_end        = p.get<double>     ("FlashVetoTimeEnd",      1000000);
+  _async_tree_writing      = p.get<bool>       ("AsyncTreeWriting",      false);
+  if (_async_tree_writing) ubxsec::EnableROOTThreadSafety();
     
   _mgr.Configure(p.get<flashana::Config_t>("FlashMatchConfig"));
 
@@ -129,6 +133,7 @@ CosmicFlashMatch::CosmicFlashMatch(fhicl::ParameterSet const & p)
     _tree1->Branch("fv",              &_fv,                              "fv/I");
     _tree1->Branch("ccnc",            &_ccnc,                            "ccnc/I");
     _tree1->Branch("nupdg",           &_nupdg,                           "nupdg/I");
+    _tree_filler.Init(_tree1, _async_tree_writing);
   }
 
 
@@ -139,6 +144,8 @@ CosmicFlashMatch::CosmicFlashMatch(fhicl::ParameterSet const & p)
 
 void CosmicFlashMatch::produce(art::Event & e)
 {
+  // The tree variables may still be read by the previous event fill
+  _tree_filler.Wait();
 
   std::cout << "CosmicFlashMatch starts." << std::endl;
 
@@ -369,13 +376,18 @@ void CosmicFlashMatch::produce(art::Event & e)
   e.put(std::move(assnOutFlashMatchPFParticle));
 
 
-  if (_debug) _tree1->Fill();
+  if (_debug) _tree_filler.Fill();
 
   std::cout << "CosmicFlashMatch ends." << std::endl;
 }
 
 
 
+//______________________________________________________________________________________________________________________________________
+void CosmicFlashMatch::endJob() {
+
+  _tree_filler.Wait();
+}
 
 
 
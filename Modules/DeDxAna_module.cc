@@ -31,6 +31,10 @@
 
 #include "uboone/UBXSec/Algorithms/UBXSecHelper.h"
 #include "uboone/UBXSec/Algorithms/FindDeadRegions.h"
+#include "uboone/UBXSec/Algorithms/FindDeadRegionsService.h"
+#include "uboone/UBXSec/Algorithms/FiducialVolume.h"
+#include "uboone/UBXSec/Algorithms/TrackSummaryTable.h"
+#include "uboone/UBXSec/Algorithms/AsyncTreeWriter.h"
 
 #include "larevt/CalibrationDBI/Interface/DetPedestalService.h"
 #include "larevt/CalibrationDBI/Interface/DetPedestalProvider.h"
@@ -106,7 +110,7 @@ DeDxAna::DeDxAna(fhicl::ParameterSet const & p)
 
 void DeDxAna::analyze(art::Event const & e) {
 
-  FindDeadRegions deadRegionsFinder;
+  FindDeadRegions & deadRegionsFinder = art::ServiceHandle<FindDeadRegionsService>()->GetProvider();
 
   art::Handle<std::vector<recob::Track>> track_h;
   e.getByLabel("pandoraNu",track_h);
@@ -153,6 +157,19 @@ void DeDxAna::analyze(art::Event const & e) {
 
 
 
+  // Length and end points of all the tracks, computed once
+  ::ubxsec::TrackSummaryTable track_summaries;
+  track_summaries.Fill(*track_h);
+
+  // Classify the start and end points of all the tracks at once
+  ::ubxsec::FiducialVolume fiducial_volume;
+  size_t n_tracks = track_h->size();
+  std::vector<unsigned char> fv_flags(n_tracks);
+  fiducial_volume.ClassifyTracks(n_tracks,
+                                 track_summaries.StartX().data(), track_summaries.StartY().data(), track_summaries.StartZ().data(),
+                                 track_summaries.EndX().data(),   track_summaries.EndY().data(),   track_summaries.EndZ().data(),
+                                 fv_flags.data());
+
   // Track loop
   for (unsigned int trk = 0; trk < track_h->size(); trk++) {
 
@@ -161,15 +178,15 @@ void DeDxAna::analyze(art::Event const & e) {
 
     auto const& track = (*track_h)[trk];
 
-    double track_length = track.Length();
+    double track_length = track_summaries.Length(trk);
     if (track_length < 50) {
       std::cout << "Track length is less than a 50cm. Continue." << std::endl;       
       continue;
     }
 
     // Get only tracks that cross the boundary
-    int vtx_ok;
-    if(!UBXSecHelper::IsCrossingBoundary(track, vtx_ok)) {
+    int vtx_ok = ::ubxsec::FiducialVolume::VertexOk(fv_flags[trk]);
+    if(!(fv_flags[trk] & ::ubxsec::FiducialVolume::kCrossing)) {
       std::cout << "Track is not crossing boundaries. Continue." << std::endl;
       continue;
     }
@@ -317,7 +334,11 @@ void DeDxAna::analyze(art::Event const & e) {
     }
   }
 
-  _tree1->Fill();
+  {
+    // Other modules may be writing their trees to the same file from their own threads
+    std::lock_guard<std::mutex> io_lock(ubxsec::TreeIOMutex());
+    _tree1->Fill();
+  }
 
 
 }
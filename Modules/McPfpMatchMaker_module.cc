@@ -0,0 +1,152 @@
+////////////////////////////////////////////////////////////////////////
+// Class:       McPfpMatchMaker
+// Plugin Type: producer (art v2_05_00)
+// File:        McPfpMatchMaker_module.cc
+//
+// Generated at Fri Jun  2 11:12:43 2017 by Marco Del Tutto using cetskelgen
+// from cetlib version v1_21_00.
+////////////////////////////////////////////////////////////////////////
+
+/**
+ * \file McPfpMatchMaker_module.cc
+ *
+ * \ingroup UBXSec
+ * 
+ * \brief LArSoft plugin to store the MCParticle to PFParticle matching
+ *
+ * Runs the hit based MCParticle to PFParticle matching (McPfpMatch) once
+ * and stores it as an association, with the hit counts of each match as
+ * payload, so that analyzers do not have to repeat the backtracking.
+ *
+ * @author Marco Del Tutto
+ */
+
+/** \addtogroup UBXSec
+
+   @{*/
+#include "art/Framework/Core/EDProducer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Principal/Event.h"
+#include "art/Framework/Principal/Handle.h"
+#include "art/Framework/Principal/Run.h"
+#include "art/Framework/Principal/SubRun.h"
+#include "canvas/Persistency/Common/Assns.h"
+#include "canvas/Utilities/InputTag.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+#include "lardataobj/RecoBase/PFParticle.h"
+#include "nusimdata/SimulationBase/MCParticle.h"
+#include "larpandora/LArPandoraInterface/LArPandoraHelper.h"
+
+#include "uboone/UBXSec/DataTypes/McPfpMatchData.h"
+#include "uboone/UBXSec/Algorithms/McPfpMatch.h"
+
+#include <memory>
+
+namespace ubana {
+  class McPfpMatchMaker;
+}
+
+
+class ubana::McPfpMatchMaker : public art::EDProducer {
+public:
+  explicit McPfpMatchMaker(fhicl::ParameterSet const & p);
+  // The compiler-generated destructor is fine for non-base
+  // classes without bare pointers or other resource use.
+
+  // Plugins should not be copied or assigned.
+  McPfpMatchMaker(McPfpMatchMaker const &) = delete;
+  McPfpMatchMaker(McPfpMatchMaker &&) = delete;
+  McPfpMatchMaker & operator = (McPfpMatchMaker const &) = delete;
+  McPfpMatchMaker & operator = (McPfpMatchMaker &&) = delete;
+
+  // Required functions.
+  void produce(art::Event & e) override;
+
+private:
+
+  std::string _pfp_producer;
+  std::string _spacepointLabel;
+  std::string _hitfinderLabel;
+  std::string _geantModuleLabel;
+  bool _recursiveMatching;
+  bool _use_simchannel_backtracking; ///< If true, backtracks hits from the SimChannels instead of the BackTracker service
+  bool _debug;
+
+  ubxsec::McPfpMatch mcpfpMatcher;
+};
+
+
+ubana::McPfpMatchMaker::McPfpMatchMaker(fhicl::ParameterSet const & p)
+// :
+// Initialize member data here.
+{
+  _pfp_producer      = p.get<std::string>("PFParticleProducer", "pandoraNu");
+  _spacepointLabel   = p.get<std::string>("SpacePointProducer", "pandoraNu");
+  _hitfinderLabel    = p.get<std::string>("HitProducer");
+  _geantModuleLabel  = p.get<std::string>("GeantModule", "largeant");
+  _recursiveMatching = p.get<bool>       ("RecursiveMatching", false);
+  _use_simchannel_backtracking = p.get<bool>("UseSimChannelBackTracking", false);
+  _debug             = p.get<bool>       ("Debug", false);
+
+  produces< art::Assns<simb::MCParticle, recob::PFParticle, ubana::McPfpMatchData> >();
+}
+
+void ubana::McPfpMatchMaker::produce(art::Event & e){
+
+  if (_debug) std::cout << "[McPfpMatchMaker] Starts" << std::endl;
+
+  // Instantiate the output
+  std::unique_ptr< art::Assns<simb::MCParticle, recob::PFParticle, ubana::McPfpMatchData> > assnOutMcPfp(new art::Assns<simb::MCParticle, recob::PFParticle, ubana::McPfpMatchData>);
+
+  if (e.isRealData()) {
+    if (_debug) std::cout << "[McPfpMatchMaker] Running on a real data file. No MC-PFP matching will be attempted." << std::endl;
+    e.put(std::move(assnOutMcPfp));
+    return;
+  }
+
+  if (_use_simchannel_backtracking) {
+    ubxsec::SimChannelBackTracker simch_bt(e, _geantModuleLabel, _geantModuleLabel);
+    mcpfpMatcher.Configure(e, _pfp_producer, _spacepointLabel, _hitfinderLabel, _geantModuleLabel, simch_bt);
+  } else {
+    mcpfpMatcher.Configure(e, _pfp_producer, _spacepointLabel, _hitfinderLabel, _geantModuleLabel);
+  }
+
+  lar_pandora::MCParticlesToPFParticles matchedParticles;
+  lar_pandora::MCParticlesToHits        matchedParticleHits;
+  mcpfpMatcher.GetRecoToTrueMatches(matchedParticles, matchedParticleHits, _recursiveMatching);
+
+  const ubxsec::RecoTrueMatcher & matcher = mcpfpMatcher.GetMatcher();
+
+  for (auto const & iter : matchedParticles) {
+
+    art::Ptr<simb::MCParticle>  mc_par = iter.first;
+    art::Ptr<recob::PFParticle> pf_par = iter.second;
+
+    int n_matched_hits = 0;
+    auto hit_iter = matchedParticleHits.find(mc_par);
+    if (hit_iter != matchedParticleHits.end()) n_matched_hits = hit_iter->second.size();
+
+    ubana::McPfpMatchData data(n_matched_hits, matcher.NRecoHits(pf_par), matcher.NTrueHits(mc_par));
+
+    if (_debug) std::cout << "[McPfpMatchMaker] MCParticle with pdg " << mc_par->PdgCode()
+                          << " matched to PFP " << pf_par->Self()
+                          << ", shared hits: " << data.GetNMatchedHits()
+                          << ", purity: " << data.GetPurity()
+                          << ", completeness: " << data.GetCompleteness() << std::endl;
+
+    assnOutMcPfp->addSingle(mc_par, pf_par, data);
+  }
+
+  if (_debug) std::cout << "[McPfpMatchMaker] Number of matches: " << assnOutMcPfp->size() << std::endl;
+
+  e.put(std::move(assnOutMcPfp));
+
+  if (_debug) std::cout << "[McPfpMatchMaker] Ends" << std::endl;
+}
+
+DEFINE_ART_MODULE(ubana::McPfpMatchMaker)
+
+  /** @} */ // end of doxygen group
+
@@ -45,6 +45,8 @@
 
 #include "uboone/UBXSec/DataTypes/FlashMatch.h"
 #include "uboone/UBXSec/Algorithms/UBXSecHelper.h"
+#include "uboone/UBXSec/Algorithms/FiducialVolume.h"
+#include "uboone/UBXSec/Algorithms/AsyncTreeWriter.h"
 
 #include "TTree.h"
 
@@ -86,6 +88,7 @@ public:
 
   // Required functions.
   void produce(art::Event & e) override;
+  void endJob() override;
 
 private:
   std::string _pfp_producer;           ///<
@@ -96,6 +99,7 @@ private:
   double _flash_trange_end;            ///<
   bool _debug;                         ///<
   bool _use_genie_info;                ///<
+  ::ubxsec::FiducialVolume _fiducial_volume; ///< FV used to flag the true neutrino vertex
 
   std::vector<::flashana::Flash_t>    beam_flashes;
 
@@ -105,6 +109,8 @@ private:
   std::vector<double>    _xfixed_hypo_spec;
   double _xfixed_chi2, _xfixed_ll;
 
+  bool _async_tree_writing;  ///< If true, the tree is filled on a background thread
+  ubxsec::AsyncTreeFiller _tree_filler;
   TTree* _tree1;
   int _run, _subrun, _event, _matchid, _flashid;
   std::vector<double>               _score, _t0;
@@ -126,9 +132,13 @@ NeutrinoFlashMatch::NeutrinoFlashMatch(fhicl::ParameterSet const & p)
   _flash_trange_start      = p.get<double>     ("FlashVetoTimeStart",    3);
   _flash_trange_end        = p.get<double>     ("FlashVetoTimeEnd",      5);
   _use_genie_info          = p.get<bool>       ("UseGENIEInfo",          true); 
+  _async_tree_writing      = p.get<bool>       ("AsyncTreeWriting",      false);
+  if (_async_tree_writing) ubxsec::EnableROOTThreadSafety();
     
   _mgr.Configure(p.get<flashana::Config_t>("FlashMatchConfig"));
 
+  _fiducial_volume.Configure(p.get<fhicl::ParameterSet>("FiducialVolumeSettings", fhicl::ParameterSet()));
+
   if (_debug) {
     art::ServiceHandle<art::TFileService> fs;
     _tree1 = fs->make<TTree>("flashmatchtree","");
@@ -146,6 +156,7 @@ NeutrinoFlashMatch::NeutrinoFlashMatch(fhicl::ParameterSet const & p)
     _tree1->Branch("fv",              &_fv,                              "fv/I");
     _tree1->Branch("ccnc",            &_ccnc,                            "ccnc/I");
     _tree1->Branch("nupdg",           &_nupdg,                           "nupdg/I");
+    _tree_filler.Init(_tree1, _async_tree_writing);
   }
 
 
@@ -156,6 +167,8 @@ NeutrinoFlashMatch::NeutrinoFlashMatch(fhicl::ParameterSet const & p)
 
 void NeutrinoFlashMatch::produce(art::Event & e)
 {
+  // The tree variables may still be read by the previous event fill
+  _tree_filler.Wait();
 
   if(_debug) std::cout << "NeutrinoFlashMatch starts." << std::endl;
 
@@ -396,14 +409,14 @@ void NeutrinoFlashMatch::produce(art::Event & e)
  
     int iList = 0; // 1 nu int per spill
     double truth_nu_vtx[3] = {mclist[iList]->GetNeutrino().Nu().Vx(),mclist[iList]->GetNeutrino().Nu().Vy(),mclist[iList]->GetNeutrino().Nu().Vz()}; 
-    if (UBXSecHelper::InFV(truth_nu_vtx)) _fv = 1;
+    if (_fiducial_volume.InFV(truth_nu_vtx)) _fv = 1;
     else _fv = 0;
 
     _ccnc    = mclist[iList]->GetNeutrino().CCNC();
     _nupdg   = mclist[iList]->GetNeutrino().Nu().PdgCode();
   }
 
-  if (_debug) _tree1->Fill();
+  if (_debug) _tree_filler.Fill();
 
   if (_debug) std::cout << "NeutrinoFlashMatch ends." << std::endl;
 
@@ -413,6 +426,13 @@ void NeutrinoFlashMatch::produce(art::Event & e)
 
 
 
+//______________________________________________________________________________________________________________________________________
+void NeutrinoFlashMatch::endJob() {
+
+  _tree_filler.Wait();
+}
+
+
 
 //______________________________________________________________________________________________________________________________________
 flashana::QCluster_t NeutrinoFlashMatch::GetQCluster(std::vector<art::Ptr<recob::PFParticle>> pfp_v, lar_pandora::PFParticlesToSpacePoints pfp_to_spacept, lar_pandora::SpacePointsToHits spacept_to_hits) {
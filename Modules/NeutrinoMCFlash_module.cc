@@ -27,6 +27,8 @@
 #include "lardata/DetectorInfoServices/DetectorClocksService.h"
 #include "larcore/Geometry/Geometry.h"
 
+#include "uboone/UBXSec/Algorithms/PMTTable.h"
+
 #include <memory>
 
 class NeutrinoMCFlash;
@@ -118,10 +120,7 @@ void NeutrinoMCFlash::produce(art::Event & e)
   }
 
   // opdet=>opchannel mapping
-  std::vector<size_t> opdet2opch(geo->NOpDets(),0);
-  for(size_t opch=0; opch<opdet2opch.size(); ++opch){
-    opdet2opch[geo->OpDetFromOpChannel(opch)] = opch;
-  }
+  ubxsec::PMTTable const & pmt_table = ubxsec::PMTTable::Instance();
 
   auto const & evt_trigger = (*evt_trigger_h)[0];
   auto const trig_time = evt_trigger.TriggerTime();
@@ -176,7 +175,7 @@ void NeutrinoMCFlash::produce(art::Event & e)
       if (oneph.Time > nuTime + 8000 ) continue;
       if (oneph.Time > nuTime - 100){ 
         if (_debug) std::cout << " photon time " << oneph.Time << std::endl;
-        pmt_v[0][opdet2opch[opdet]] += 1;
+        pmt_v[0][pmt_table.OpDetToOpChannel(opdet)] += 1;
       }
     }
   }
@@ -208,38 +207,7 @@ void NeutrinoMCFlash::GetFlashLocation(std::vector<double> pePerOpChannel,
                                        double& Ywidth,
                                        double& Zwidth)
 {
-
-  // Reset variables
-  Ycenter = Zcenter = 0.;
-  Ywidth  = Zwidth  = -999.;
-  double totalPE = 0.;
-  double sumy = 0., sumz = 0., sumy2 = 0., sumz2 = 0.;
-
-  for (unsigned int opch = 0; opch < pePerOpChannel.size(); opch++) {
-
-    // Get physical detector location for this opChannel
-    double PMTxyz[3];
-    ::art::ServiceHandle<geo::Geometry> geo;
-    geo->OpDetGeoFromOpChannel(opch).GetCenter(PMTxyz);
-
-    // Add up the position, weighting with PEs
-    sumy    += pePerOpChannel[opch]*PMTxyz[1];
-    sumy2   += pePerOpChannel[opch]*PMTxyz[1]*PMTxyz[1];
-    sumz    += pePerOpChannel[opch]*PMTxyz[2];
-    sumz2   += pePerOpChannel[opch]*PMTxyz[2]*PMTxyz[2];
-
-    totalPE += pePerOpChannel[opch];
-  }
-
-  Ycenter = sumy/totalPE;
-  Zcenter = sumz/totalPE;
-
-  // This is just sqrt(<x^2> - <x>^2)
-  if ( (sumy2*totalPE - sumy*sumy) > 0. )
-    Ywidth = std::sqrt(sumy2*totalPE - sumy*sumy)/totalPE;
-
-  if ( (sumz2*totalPE - sumz*sumz) > 0. )
-    Zwidth = std::sqrt(sumz2*totalPE - sumz*sumz)/totalPE;
+  ubxsec::PMTTable::Instance().FlashLocation(pePerOpChannel, Ycenter, Zcenter, Ywidth, Zwidth);
 }
 
 
@@ -30,6 +30,9 @@
 #include "lardata/DetectorInfoServices/DetectorClocksService.h"
 #include "larcore/Geometry/Geometry.h"
 
+#include "uboone/UBXSec/Algorithms/PMTTable.h"
+#include "uboone/UBXSec/Algorithms/AsyncTreeWriter.h"
+
 #include "TTree.h"
 
 #include <memory>
@@ -135,11 +138,6 @@ void PhotonActivity::produce(art::Event & e)
     return;
   }
 
-  // opdet=>opchannel mapping
-  std::vector<size_t> opdet2opch(geo->NOpDets(),0);
-  for(size_t opch=0; opch<opdet2opch.size(); ++opch){
-    opdet2opch[geo->OpDetFromOpChannel(opch)] = opch;
-  }
 
   
   auto const & evt_trigger = (*evt_trigger_h)[0];
@@ -204,7 +202,11 @@ void PhotonActivity::produce(art::Event & e)
     }
   }
 
-  _tree1->Fill();
+  {
+    // Other modules may be writing their trees to the same file from their own threads
+    std::lock_guard<std::mutex> io_lock(ubxsec::TreeIOMutex());
+    _tree1->Fill();
+  }
 
   if (_debug) std::cout << "***** PhotonActivity ends." << std::endl;
 
@@ -219,38 +221,7 @@ void PhotonActivity::GetFlashLocation(std::vector<double> pePerOpChannel,
                                        double& Ywidth,
                                        double& Zwidth)
 {
-
-  // Reset variables
-  Ycenter = Zcenter = 0.;
-  Ywidth  = Zwidth  = -999.;
-  double totalPE = 0.;
-  double sumy = 0., sumz = 0., sumy2 = 0., sumz2 = 0.;
-
-  for (unsigned int opch = 0; opch < pePerOpChannel.size(); opch++) {
-
-    // Get physical detector location for this opChannel
-    double PMTxyz[3];
-    ::art::ServiceHandle<geo::Geometry> geo;
-    geo->OpDetGeoFromOpChannel(opch).GetCenter(PMTxyz);
-
-    // Add up the position, weighting with PEs
-    sumy    += pePerOpChannel[opch]*PMTxyz[1];
-    sumy2   += pePerOpChannel[opch]*PMTxyz[1]*PMTxyz[1];
-    sumz    += pePerOpChannel[opch]*PMTxyz[2];
-    sumz2   += pePerOpChannel[opch]*PMTxyz[2]*PMTxyz[2];
-
-    totalPE += pePerOpChannel[opch];
-  }
-
-  Ycenter = sumy/totalPE;
-  Zcenter = sumz/totalPE;
-
-  // This is just sqrt(<x^2> - <x>^2)
-  if ( (sumy2*totalPE - sumy*sumy) > 0. )
-    Ywidth = std::sqrt(sumy2*totalPE - sumy*sumy)/totalPE;
-
-  if ( (sumz2*totalPE - sumz*sumz) > 0. )
-    Zwidth = std::sqrt(sumz2*totalPE - sumz*sumz)/totalPE;
+  ubxsec::PMTTable::Instance().FlashLocation(pePerOpChannel, Ycenter, Zcenter, Ywidth, Zwidth);
 }
 
 
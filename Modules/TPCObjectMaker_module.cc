@@ -39,6 +39,7 @@
 #include "larpandora/LArPandoraInterface/LArPandoraHelper.h"
 
 #include "uboone/UBXSec/DataTypes/TPCObject.h"
+#include "uboone/UBXSec/Algorithms/PFPHierarchy.h"
 
 #include <memory>
 
@@ -62,26 +63,15 @@ public:
   // Required functions.
   void produce(art::Event & e) override;
 
-  /**
-   *  @brief Gets all the tracks and PFP for a single Pandora slice
-   *
-   *  @param pfParticleList the list of PFP
-   *  @param pfParticleToTrackMap map from PFP to tracks
-   *  @param particle the PFP
-   *  @param pfp_v output, a vector of PFP (the TPC object)
-   *  @param track_v output, a of tracks (the TPC object)   */
-  void CollectTracksAndPFP(lar_pandora::PFParticlesToTracks pfParticleToTrackMap, lar_pandora::PFParticleVector pfParticleList, art::Ptr<recob::PFParticle> particle, lar_pandora::PFParticleVector &pfp_v, lar_pandora::TrackVector &track_v);
-
   /**
    *  @brief Constructs TPC objects using Pandora PFP slices
    *
-   *  @param pfParticleList the list of PFP
+   *  @param hierarchy the PFP hierarchy
    *  @param pfParticleToTrackMap map from PFP to tracks
    *  @param pfParticleToVertexMap map from PFP to vertices
-   *  @param _particleLabel the PFP producer module
    *  @param pfp_v_v output, a vector of vector of PFP (a vector of TPC objects)
    *  @param track_v_v output, a vector of vector of tracks (a vector of TPC objects)   */
-  void GetTPCObjects(lar_pandora::PFParticleVector pfParticleList, lar_pandora::PFParticlesToTracks pfParticleToTrackMap, lar_pandora::PFParticlesToVertices  pfParticleToVertexMap, std::vector<lar_pandora::PFParticleVector> & pfp_v_v, std::vector<lar_pandora::TrackVector> & track_v_v);
+  void GetTPCObjects(ubxsec::PFPHierarchy const & hierarchy, lar_pandora::PFParticlesToTracks const & pfParticleToTrackMap, lar_pandora::PFParticlesToVertices const & pfParticleToVertexMap, std::vector<lar_pandora::PFParticleVector> & pfp_v_v, std::vector<lar_pandora::TrackVector> & track_v_v);
 
 
   /**
@@ -136,7 +126,9 @@ void ubana::TPCObjectMaker::produce(art::Event & e){
   std::vector<lar_pandora::TrackVector     > track_v_v;
   std::vector<lar_pandora::PFParticleVector> pfp_v_v;
 
-  this->GetTPCObjects(pfParticleList, pfParticleToTrackMap, pfParticleToVertexMap, pfp_v_v, track_v_v);
+  ubxsec::PFPHierarchy hierarchy(pfParticleList);
+
+  this->GetTPCObjects(hierarchy, pfParticleToTrackMap, pfParticleToVertexMap, pfp_v_v, track_v_v);
 
 
   for (size_t i = 0; i < pfp_v_v.size(); i++){
@@ -182,9 +174,9 @@ art::Ptr<recob::PFParticle> ubana::TPCObjectMaker::GetNuPFP(lar_pandora::PFParti
 
 
 //___________________________________________________________________________________________________
-void ubana::TPCObjectMaker::GetTPCObjects(lar_pandora::PFParticleVector pfParticleList,
-                                            lar_pandora::PFParticlesToTracks pfParticleToTrackMap,
-                                            lar_pandora::PFParticlesToVertices  pfParticleToVertexMap,
+void ubana::TPCObjectMaker::GetTPCObjects(ubxsec::PFPHierarchy const & hierarchy,
+                                            lar_pandora::PFParticlesToTracks const & pfParticleToTrackMap,
+                                            lar_pandora::PFParticlesToVertices const & pfParticleToVertexMap,
                                             std::vector<lar_pandora::PFParticleVector> & pfp_v_v,
                                             std::vector<lar_pandora::TrackVector> & track_v_v) {
 
@@ -193,8 +185,8 @@ void ubana::TPCObjectMaker::GetTPCObjects(lar_pandora::PFParticleVector pfPartic
 
   if (_debug) std::cout << "[TPCObjectMaker] Getting TPC Objects..." << std::endl;
 
-  for (unsigned int n = 0; n < pfParticleList.size(); ++n) {
-    const art::Ptr<recob::PFParticle> particle = pfParticleList.at(n);
+  for (unsigned int n = 0; n < hierarchy.size(); ++n) {
+    const art::Ptr<recob::PFParticle> particle = hierarchy.GetPFP(n);
 
     if(lar_pandora::LArPandoraHelper::IsNeutrino(particle)) {
       if (_debug) std::cout << "[TPCObjectMaker] \t Creating TPC Object " << track_v_v.size() << std::endl;
@@ -212,7 +204,7 @@ void ubana::TPCObjectMaker::GetTPCObjects(lar_pandora::PFParticleVector pfPartic
       lar_pandora::TrackVector track_v;
       lar_pandora::PFParticleVector pfp_v;
 
-      this->CollectTracksAndPFP(pfParticleToTrackMap, pfParticleList, particle, pfp_v, track_v);
+      hierarchy.CollectPFPAndObjects(n, pfParticleToTrackMap, pfp_v, track_v);
 
       pfp_v_v.emplace_back(pfp_v);
       track_v_v.emplace_back(track_v);
@@ -237,35 +229,6 @@ void ubana::TPCObjectMaker::GetTPCObjects(lar_pandora::PFParticleVector pfPartic
   } // end pfp loop
 }
 
-//______________________________________________________________________________________________________________________________________
-void ubana::TPCObjectMaker::CollectTracksAndPFP(lar_pandora::PFParticlesToTracks pfParticleToTrackMap,
-                                                  lar_pandora::PFParticleVector pfParticleList,
-                                                  art::Ptr<recob::PFParticle> particle,
-                                                  lar_pandora::PFParticleVector &pfp_v,
-                                                  lar_pandora::TrackVector &track_v) {
-
-  pfp_v.emplace_back(particle);
-
-  lar_pandora::PFParticlesToTracks::const_iterator trackMapIter = pfParticleToTrackMap.find(particle);
-  if (trackMapIter != pfParticleToTrackMap.end()) {
-    lar_pandora::TrackVector tracks = trackMapIter->second;
-    if (_debug) std::cout << "[TPCObjectMaker] \t PFP " << particle->Self() << " has " << tracks.size() << " tracks ass." << std::endl;
-    for (unsigned int trk = 0; trk < tracks.size(); trk++) {
-      track_v.emplace_back(tracks[trk]);
-    }
-  }
-  const std::vector<size_t> &daughterIDs = particle->Daughters();
-  if(daughterIDs.size() == 0) return;
-  else {
-    for (unsigned int m = 0; m < daughterIDs.size(); ++m) {
-      const art::Ptr<recob::PFParticle> daughter = pfParticleList.at(daughterIDs.at(m));
-      CollectTracksAndPFP(pfParticleToTrackMap, pfParticleList, daughter, pfp_v, track_v);
-    }
-  }
-
-}
-
-
 DEFINE_ART_MODULE(ubana::TPCObjectMaker)
 
   /** @} */ // end of doxygen group
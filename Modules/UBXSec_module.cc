@@ -40,6 +40,7 @@
 #include "art/Framework/Services/Optional/TFileService.h"
 #include "art/Framework/Services/Optional/TFileDirectory.h"
 #include "canvas/Persistency/Common/FindManyP.h"
+#include "canvas/Utilities/Exception.h"
 
 // Data products include
 #include "nusimdata/SimulationBase/MCParticle.h"
@@ -54,6 +55,7 @@
 #include "lardataobj/RecoBase/Hit.h"
 #include "lardataobj/RecoBase/SpacePoint.h"
 #include "uboone/UBXSec/DataTypes/FlashMatch.h"
+#include "uboone/UBXSec/DataTypes/McPfpMatchData.h"
 #include "lardataobj/AnalysisBase/T0.h"
 
 // LArSoft include
@@ -68,9 +70,24 @@
 
 // Algorithms include
 #include "uboone/UBXSec/Algorithms/UBXSecHelper.h"
+#include "uboone/UBXSec/Algorithms/PandoraEventCache.h"
 #include "uboone/UBXSec/Algorithms/VertexCheck.h"
 #include "uboone/UBXSec/Algorithms/McPfpMatch.h"
+#include "uboone/UBXSec/Algorithms/BackTrackerCache.h"
+#include "uboone/UBXSec/Algorithms/SimChannelBackTracker.h"
 #include "uboone/UBXSec/Algorithms/FindDeadRegions.h"
+#include "uboone/UBXSec/Algorithms/FindDeadRegionsService.h"
+#include "uboone/UBXSec/Algorithms/FiducialVolume.h"
+#include "uboone/UBXSec/Algorithms/PMTTable.h"
+#include "uboone/UBXSec/Algorithms/OpHitIndex.h"
+#include "uboone/UBXSec/Algorithms/FlatRecords.h"
+#include "uboone/UBXSec/Algorithms/AsyncTreeWriter.h"
+
+// C++ include
+#include <atomic>
+#include <exception>
+#include <sstream>
+#include <thread>
 
 // Root include
 #include "TString.h"
@@ -78,16 +95,6 @@
 #include "TH2F.h"
 
 
-namespace ubxsec {
-  struct Hit3D_t {
-    double x;
-    double y;
-    double z;
-    double q;
-  };
-}
-
-
 class UBXSec;
 
 
@@ -105,12 +112,16 @@ public:
 
   // Required functions.
   void analyze(art::Event const & e) override;
+  void endJob() override;
 
 private:
 
-  FindDeadRegions deadRegionsFinder;
+  /// Fills the flat event, slice and flash trees from the nested tree variables
+  void FillFlatTrees();
+
   ubxsec::McPfpMatch mcpfpMatcher;
   ::pmtana::PECalib _pecalib;
+  ::ubxsec::FiducialVolume _fiducial_volume;
 
   std::string _hitfinderLabel;
   std::string _pfp_producer;
@@ -121,8 +132,20 @@ private:
   std::string _cosmic_flash_match_producer;
   std::string _opflash_producer_beam;
   std::string _acpt_producer;
+  std::string _mctrack_producer;
+  std::string _mcpfp_match_producer;
   bool _recursiveMatching;
+  bool _use_simchannel_backtracking;       ///< If true, backtracks hits from the SimChannels instead of the BackTracker service
   bool _debug;
+  bool _save_dead_region_histos;           ///< If true, fills the dead region histograms with the first event
+  int _dead_ch_window;                     ///< Number of channels checked on each side of the vertex channel for dead channels
+  int _n_slice_threads;                    ///< Number of threads the slices are analysed with (1: serial, 0: one per core)
+  bool _write_nested_tree;                 ///< If true, fills the tree with one entry per event and vector branches
+  bool _write_flat_trees;                  ///< If true, fills the flat event, slice and flash trees
+  int _flat_basket_size;                   ///< Basket size (bytes) of the flat tree branches
+  bool _async_tree_writing;                ///< If true, the trees are filled on background threads
+  int _async_tree_queue_depth;             ///< Maximum number of flat tree records waiting to be written, per tree
+  bool _dead_region_histos_filled = false;
   int _minimumHitRequirement; ///< Minimum number of hits in at least a plane for a track
   bool _use_genie_info; ///< Turn this off if looking at cosmic only files
   double _beam_spill_start; 
@@ -157,6 +180,7 @@ private:
   double _mc_start_x, _mc_start_y, _mc_start_z;
   double _mc_end_x, _mc_end_y, _mc_end_z;
   int _mc_contained;
+  int _is_golden; ///< 1 if the true numu CC muon is contained and mostly outside dead regions
   double _vtx_resolution;
 
   int _nslices;
@@ -169,6 +193,7 @@ private:
   std::vector<int> _slc_origin;
   std::vector<int> _slc_nhits_u, _slc_nhits_v, _slc_nhits_w;
   std::vector<double> _slc_longesttrack_length;
+  std::vector<double> _slc_longesttrack_deadfraction; ///< Fraction of the longest track length in a region dead on two planes
   std::vector<int> _slc_acpt_outoftime;
   std::vector<int> _slc_crosses_top_boundary;
   std::vector<int> _slc_nuvtx_closetodeadregion_u, _slc_nuvtx_closetodeadregion_v, _slc_nuvtx_closetodeadregion_w;
@@ -197,6 +222,15 @@ private:
   double _score;
   int _is_muon;
 
+  TTree* _flat_event_tree;
+  TTree* _flat_slice_tree;
+  TTree* _flat_flash_tree;
+  ubxsec::AsyncTreeFiller _tree_filler;   ///< Fills _tree1, whose branches point to the module members
+  Long64_t _n_flat_events = 0;             ///< Number of entries committed to the flat event tree
+  ubxsec::AsyncTreeWriter<ubxsec::FlatEventRecord> _flat_event_writer;
+  ubxsec::AsyncTreeWriter<ubxsec::FlatSliceRecord> _flat_slice_writer;
+  ubxsec::AsyncTreeWriter<ubxsec::FlatFlashRecord> _flat_flash_writer;
+
   TH2F * _deadRegion2P;
   TH2F * _deadRegion3P;
 };
@@ -214,6 +248,8 @@ UBXSec::UBXSec(fhicl::ParameterSet const & p)
   _cosmic_flash_match_producer    = p.get<std::string>("CosmicFlashMatchProducer");
   _opflash_producer_beam          = p.get<std::string>("OpFlashBeamProducer");
   _acpt_producer                  = p.get<std::string>("ACPTProducer");
+  _mctrack_producer               = p.get<std::string>("MCTrackProducer", "mcreco");
+  _mcpfp_match_producer           = p.get<std::string>("McPfpMatchProducer", "");
     
   _use_genie_info                 = p.get<bool>("UseGENIEInfo", false);
   _minimumHitRequirement          = p.get<int>("MinimumHitRequirement", 3);
@@ -222,10 +258,25 @@ UBXSec::UBXSec(fhicl::ParameterSet const & p)
   _beam_spill_end                 = p.get<double>("BeamSpillEnd",   4.8);
 
   _recursiveMatching		  = p.get<bool>("RecursiveMatching", false);
+  _use_simchannel_backtracking    = p.get<bool>("UseSimChannelBackTracking", false);
   _debug			  = p.get<bool>("PrintDebug", true);
+  _save_dead_region_histos        = p.get<bool>("SaveDeadRegionHistos", false);
+  _dead_ch_window                 = p.get<int>("DeadChannelWindow", 5);
+  _n_slice_threads                = p.get<int>("NSliceThreads", 1);
+  _write_nested_tree              = p.get<bool>("WriteNestedTree", true);
+  _write_flat_trees               = p.get<bool>("WriteFlatTrees", false);
+  _flat_basket_size               = p.get<int>("FlatTreeBasketSize", 256000);
+  _async_tree_writing             = p.get<bool>("AsyncTreeWriting", false);
+  _async_tree_queue_depth         = p.get<int>("AsyncTreeQueueDepth", 64);
+
+  // Before any ROOT object is made
+  if (_async_tree_writing) ubxsec::EnableROOTThreadSafety();
 
   _pecalib.Configure(p.get<fhicl::ParameterSet>("PECalib"));
 
+  _fiducial_volume.Configure(p.get<fhicl::ParameterSet>("FiducialVolumeSettings", fhicl::ParameterSet()));
+  _fiducial_volume.PrintConfig();
+
   art::ServiceHandle<art::TFileService> fs;
   _tree1 = fs->make<TTree>("tree","");
   _tree1->Branch("run",                  &_run,                   "run/I");
@@ -257,6 +308,7 @@ UBXSec::UBXSec(fhicl::ParameterSet const & p)
   _tree1->Branch("mc_end_y",             &_mc_end_y,              "mc_end_y/D");
   _tree1->Branch("mc_end_z",             &_mc_end_z,              "mc_end_z/D");
   _tree1->Branch("mc_contained",         &_mc_contained,          "mc_contained/I");
+  _tree1->Branch("is_golden",            &_is_golden,             "is_golden/I");
   _tree1->Branch("is_swtriggered",       &_is_swtriggered,        "is_swtriggered/I");
   _tree1->Branch("vtx_resolution",       &_vtx_resolution,        "vtx_resolution/D");
 
@@ -280,6 +332,7 @@ UBXSec::UBXSec(fhicl::ParameterSet const & p)
   _tree1->Branch("slc_nhits_v",                    "std::vector<int>",    &_slc_nhits_v);
   _tree1->Branch("slc_nhits_w",                    "std::vector<int>",    &_slc_nhits_w);
   _tree1->Branch("slc_longesttrack_length",        "std::vector<double>", &_slc_longesttrack_length);
+  _tree1->Branch("slc_longesttrack_deadfraction",  "std::vector<double>", &_slc_longesttrack_deadfraction);
   _tree1->Branch("slc_acpt_outoftime",             "std::vector<int>",    &_slc_acpt_outoftime);
   _tree1->Branch("slc_crosses_top_boundary",       "std::vector<int>",    &_slc_crosses_top_boundary);
   _tree1->Branch("slc_nuvtx_closetodeadregion_u",  "std::vector<int>",    &_slc_nuvtx_closetodeadregion_u);
@@ -328,16 +381,33 @@ UBXSec::UBXSec(fhicl::ParameterSet const & p)
   _tree2->Branch("is_muon",            &_is_muon,            "is_muon/I");
   _tree2->Branch("is_reco",           &_is_reco,            "is_reco/I");
 
+  // Flat trees: plain leaves and fixed PMT arrays, slices and flashes point back to the event entry
+  _flat_event_tree = _flat_slice_tree = _flat_flash_tree = nullptr;
+  if (_write_flat_trees) {
+    _flat_event_tree = fs->make<TTree>("flat_event_tree","");
+    _flat_slice_tree = fs->make<TTree>("flat_slice_tree","");
+    _flat_flash_tree = fs->make<TTree>("flat_flash_tree","");
+    _flat_event_writer.Init(_flat_event_tree, _async_tree_writing, _flat_basket_size, _async_tree_queue_depth);
+    _flat_slice_writer.Init(_flat_slice_tree, _async_tree_writing, _flat_basket_size, _async_tree_queue_depth);
+    _flat_flash_writer.Init(_flat_flash_tree, _async_tree_writing, _flat_basket_size, _async_tree_queue_depth);
+  }
+
+  _tree_filler.Init(_tree1, _async_tree_writing);
+
   _deadRegion2P = fs->make<TH2F>("deadRegion2P","deadRegion2P", 10350,0.0,1035.0,2300,-115.0,115.0);
   _deadRegion3P = fs->make<TH2F>("deadRegion3P","deadRegion3P", 10350,0.0,1035.0,2300,-115.0,115.0);
 }
 
 void UBXSec::analyze(art::Event const & e)
 {
+  // The tree variables may still be read by the previous event fill
+  _tree_filler.Wait();
 
   if(_debug) std::cout << "********** UBXSec starts" << std::endl;
   if(_debug) std::cout << "event: " << e.id().event() << std::endl;
 
+  FindDeadRegions & deadRegionsFinder = art::ServiceHandle<FindDeadRegionsService>()->GetProvider();
+
   _run    = e.id().run();
   _subrun = e.id().subRun();
   _event  = e.id().event();
@@ -351,26 +421,37 @@ void UBXSec::analyze(art::Event const & e)
     _use_genie_info =false;
   }
 
+  // Backtracking: with UseSimChannelBackTracking the BackTracker service is never used
+  ubxsec::BackTrackerCache bt_cache; // BackTracker results for this event, filled on first use
+  ubxsec::SimChannelBackTracker simch_bt;
+  if (_is_mc && _use_simchannel_backtracking) {
+    simch_bt.Configure(e, _geantModuleLabel, _geantModuleLabel);
+  }
+
+  // MCTruth of a true particle
+  auto trackid_to_mctruth = [&](int trackid) {
+    return (_use_simchannel_backtracking ? simch_bt.TrackIDToMCTruth(trackid) : bt_cache.TrackIDToMCTruth(trackid));
+  };
+
   if (_is_data) {
     std::cout << "[UBXSec] Running on a real data file. No MC-PFP matching will be attempted." << std::endl;
-  } else {
-    mcpfpMatcher.Configure(e, _pfp_producer, _spacepointLabel, _hitfinderLabel, _geantModuleLabel);
+  } else if (_mcpfp_match_producer == "") {
+    if (_use_simchannel_backtracking)
+      mcpfpMatcher.Configure(e, _pfp_producer, _spacepointLabel, _hitfinderLabel, _geantModuleLabel, simch_bt);
+    else
+      mcpfpMatcher.Configure(e, _pfp_producer, _spacepointLabel, _hitfinderLabel, _geantModuleLabel);
   }
 
-  art::ServiceHandle<cheat::BackTracker> bt;
   ::art::ServiceHandle<geo::Geometry> geo;
 
-  // Collect tracks
-  lar_pandora::TrackVector            allPfParticleTracks;
-  lar_pandora::PFParticlesToTracks    pfParticleToTrackMap;
-  lar_pandora::LArPandoraHelper::CollectTracks(e, _pfp_producer, allPfParticleTracks, pfParticleToTrackMap);
-
+  // Collect the Pandora products (PFParticles, vertices, tracks, showers, 
+  // spacepoints and their hits) once for the whole event
+  ubxsec::PandoraEventCache pandora_cache(e, _pfp_producer);
+  ubxsec::TrackSummaryTable const & track_summaries = pandora_cache.GetTrackSummaries();
 
-  // Collect Showers and PFParticle <-> Shower Associations
-  // =====================================================
-  lar_pandora::ShowerVector allPfParticleShowers;
-  lar_pandora::PFParticlesToShowers pfParticleToShowerMap;
-  lar_pandora::LArPandoraHelper::CollectShowers(e, _pfp_producer, allPfParticleShowers, pfParticleToShowerMap);
+  // PFParticle <-> Track and PFParticle <-> Shower Associations
+  lar_pandora::PFParticlesToTracks const & pfParticleToTrackMap = pandora_cache.GetPFParticlesToTracks();
+  lar_pandora::PFParticlesToShowers const & pfParticleToShowerMap = pandora_cache.GetPFParticlesToShowers();
 
 
   // Collect PFParticles and match Reco Particles to Hits
@@ -386,10 +467,25 @@ void UBXSec::analyze(art::Event const & e)
 
 
   // Do the MCParticle to PFParticle matching
+  // Either read it from the McPfpMatchMaker output, or run it here
   lar_pandora::MCParticlesToPFParticles matchedParticles;    // This is a map: MCParticle to matched PFParticle
-  lar_pandora::MCParticlesToHits        matchedParticleHits;
-  if (_is_mc) {
-    mcpfpMatcher.GetRecoToTrueMatches(matchedParticles, matchedParticleHits);
+  std::map<art::Ptr<simb::MCParticle>, int> matchedParticleNHits;
+  if (_is_mc && _mcpfp_match_producer != "") {
+    art::Handle<art::Assns<simb::MCParticle, recob::PFParticle, ubana::McPfpMatchData>> mcpfp_h;
+    e.getByLabel(_mcpfp_match_producer, mcpfp_h);
+    if (!mcpfp_h.isValid()) {
+      // Carrying on would silently flag every slice as cosmic or unknown origin
+      throw art::Exception(art::errors::ProductNotFound)
+        << "[UBXSec] Cannot locate MC-PFP matches from " << _mcpfp_match_producer << "." << std::endl;
+    }
+    for (size_t i = 0; i < mcpfp_h->size(); i++) {
+      matchedParticles[mcpfp_h->at(i).first] = mcpfp_h->at(i).second;
+      matchedParticleNHits[mcpfp_h->at(i).first] = mcpfp_h->data(i).GetNMatchedHits();
+    }
+  } else if (_is_mc) {
+    lar_pandora::MCParticlesToHits matchedParticleHits;
+    mcpfpMatcher.GetRecoToTrueMatches(matchedParticles, matchedParticleHits, _recursiveMatching);
+    for (auto const & iter : matchedParticleHits) matchedParticleNHits[iter.first] = iter.second.size();
   }
 
 
@@ -418,7 +514,7 @@ void UBXSec::analyze(art::Event const & e)
     art::Ptr<simb::MCParticle>  mc_par = iter1->first;   // The MCParticle 
     art::Ptr<recob::PFParticle> pf_par = iter1->second;  // The matched PFParticle
 
-    const art::Ptr<simb::MCTruth> mc_truth = bt->TrackIDToMCTruth(mc_par->TrackId());
+    const art::Ptr<simb::MCTruth> mc_truth = trackid_to_mctruth(mc_par->TrackId());
 
     if (!mc_truth) {
       std::cerr << "[UBXSec] Problem with MCTruth pointer." << std::endl;
@@ -433,18 +529,16 @@ void UBXSec::analyze(art::Event const & e)
       end[0] = mc_par->EndX();
       end[1] = mc_par->EndY();
       end[2] = mc_par->EndZ();
-      if ( (mc_par->PdgCode() == 13 || mc_par->PdgCode() == -13) && UBXSecHelper::InFV(end) ){
+      if ( (mc_par->PdgCode() == 13 || mc_par->PdgCode() == -13) && _fiducial_volume.InFV(end) ){
         if(_debug) std::cout << "--- Stopping muon ---" << std::endl;
 
-        lar_pandora::VertexVector          vertexVector;
-        lar_pandora::PFParticlesToVertices particlesToVertices;
-        lar_pandora::LArPandoraHelper::CollectVertices(e, _pfp_producer, vertexVector, particlesToVertices);
-
-        lar_pandora::VertexVector vertex_v = particlesToVertices.find(pf_par)->second;
-        double xyz[3];
-        vertex_v[0]->XYZ(xyz);
+        lar_pandora::VertexVector const & vertex_v = pandora_cache.GetVertices(pf_par);
+        if (!vertex_v.empty()) {
+          double xyz[3];
+          vertex_v[0]->XYZ(xyz);
 
-        if(_debug) std::cout << "--- The PFP has vtx x="<<xyz[0]<<" y="<<xyz[1]<<" z="<<xyz[2] << " --- " << std::endl;
+          if(_debug) std::cout << "--- The PFP has vtx x="<<xyz[0]<<" y="<<xyz[1]<<" z="<<xyz[2] << " --- " << std::endl;
+        }
       }
          
     }
@@ -457,7 +551,7 @@ void UBXSec::analyze(art::Event const & e)
      art::Ptr<simb::MCParticle>  mc_par = iter1->first;   // The MCParticle 
      art::Ptr<recob::PFParticle> pf_par = iter1->second;  // The matched PFParticle
 
-     const art::Ptr<simb::MCTruth> mc_truth = bt->TrackIDToMCTruth(mc_par->TrackId());
+     const art::Ptr<simb::MCTruth> mc_truth = trackid_to_mctruth(mc_par->TrackId());
 
      if (!mc_truth) {
        std::cerr << "[UBXSec] Problem with MCTruth pointer." << std::endl;
@@ -478,8 +572,7 @@ void UBXSec::analyze(art::Event const & e)
          std::cout << "T    " << mc_par->T()       << std::endl;
          double timeCorrection = 343.75;
          if(_debug) std::cout << "Remeber a time correction of " << timeCorrection << std::endl;
-         auto iter =  matchedParticleHits.find(mc_par);
-         if(_debug) std::cout << "Related hits: " << (iter->second).size() << std::endl;
+         if(_debug) std::cout << "Related hits: " << matchedParticleNHits[mc_par] << std::endl;
        }    
        if (_debug) {
          std::cout << "  The related PFP: " << std::endl;
@@ -500,7 +593,10 @@ void UBXSec::analyze(art::Event const & e)
          _reco_pur = _reco_eff = -9999;
          auto iter = recoParticlesToHits.find(pf_par);
          if (iter != recoParticlesToHits.end()) {
-           UBXSecHelper::GetTrackPurityAndEfficiency((*iter).second, _reco_pur, _reco_eff);
+           if (_use_simchannel_backtracking)
+             UBXSecHelper::GetTrackPurityAndEfficiency(simch_bt, (*iter).second, _reco_pur, _reco_eff);
+           else
+             UBXSecHelper::GetTrackPurityAndEfficiency(bt_cache, (*iter).second, _reco_pur, _reco_eff);
          }
          _true_mom_matched = mc_par->P();
          if(_debug) std::cout << "-- efficiency: " << _reco_eff << "  purity: "  << _reco_pur << " --- " << std::endl;
@@ -556,7 +652,7 @@ void UBXSec::analyze(art::Event const & e)
          double start[3] = {_mc_start_x, _mc_start_y, _mc_start_z};
          double stop[3]  = {_mc_end_x,   _mc_end_y,   _mc_end_z};
 
-         if (UBXSecHelper::InFV(start) && UBXSecHelper::InFV(stop))
+         if (_fiducial_volume.InFV(start) && _fiducial_volume.InFV(stop))
            _mc_contained = 1;
        }
 
@@ -610,7 +706,7 @@ void UBXSec::analyze(art::Event const & e)
          double start[3] = {_mc_start_x, _mc_start_y, _mc_start_z};
          double stop[3]  = {_mc_end_x,   _mc_end_y,   _mc_end_z};
 
-         if (UBXSecHelper::InFV(start) && UBXSecHelper::InFV(stop))
+         if (_fiducial_volume.InFV(start) && _fiducial_volume.InFV(stop))
            _mc_contained = 1;
        }
      }
@@ -670,33 +766,43 @@ void UBXSec::analyze(art::Event const & e)
   }
   art::FindManyP<recob::Track> trk_kalman_v(pfp_h, e, "pandoraNuKalmanTrack");
 
-
-  // Check if golden
-  /*
-  bool is_golden = false;
-  for (auto const & mctrk : (*mctrk_h)) {
-    if (mctrk.Origin() == NEUTRINO_ORIGIN && mctrk.PdgCode() == 14) {
-      std::cout << "PPPPPPProcess is " << mctrk.Process() << std::endl;
-      for (size_t pt = 0; pt < mctrk.NumberTrajectoryPoints(); pt++){
-        float ptNearDeadRegion = 0;
-        if (NearDeadReg2P( mctrk.Vy(pt), mctrk.Vz(pt), 0.6) {
-          ptNearDeadRegion++;
+  // Fit quality of the Kalman tracks, read by the slices
+  lar_pandora::TrackVector kalman_track_v;
+  for (size_t i = 0; i < trk_kalman_v.size(); i++) {
+    for (auto const & trk : trk_kalman_v.at(i)) kalman_track_v.emplace_back(trk);
+  }
+  ubxsec::TrackSummaryTable kalman_summaries;
+  kalman_summaries.Fill(kalman_track_v);
+
+
+  // Check if golden: a neutrino induced muon, contained in the FV,
+  // with less than 5% of its length in a region dead on at least two planes
+  _is_golden = 0;
+  if (_use_genie_info) {
+    art::Handle<std::vector<sim::MCTrack> > mctrk_h;
+    e.getByLabel(_mctrack_producer, mctrk_h);
+    if (mctrk_h.isValid()) {
+      for (auto const & mctrk : (*mctrk_h)) {
+        if (mctrk.Origin() != NEUTRINO_ORIGIN || std::abs(mctrk.PdgCode()) != 13) continue;
+        if (mctrk.empty()) continue;
+        std::vector<TVector3> points;
+        points.reserve(mctrk.size());
+        for (auto const & step : mctrk) points.emplace_back(step.X(), step.Y(), step.Z());
+        DeadRegionPathLength dead = deadRegionsFinder.GetDeadPathLength(points, 0.6);
+        if (dead.DeadFraction2P() > 0.05) {
+          _is_golden = 0;
+          break;
+        }
+        double start[3] = {mctrk.Start().X(), mctrk.Start().Y(), mctrk.Start().Z()};
+        double end[3]   = {mctrk.End().X(),   mctrk.End().Y(),   mctrk.End().Z()};
+        if (_fiducial_volume.InFV(start) && _fiducial_volume.InFV(end)) {
+          _is_golden = 1;
+          break;
         }
-      } // loop over trj points
-      if (ptNearDeadRegion/(float)mctrk.NumberTrajectoryPoints() > 0.05) {
-        is_golden = false; 
-        break;
-      } 
-      double start[3] = {mctrk.Vx(),   mctrk.Vy(),   mctrk.Vz()};
-      double end[3]   = {mctrk.EndX(), mctrk.EndY(), mctrk.EndZ()};
-      if (UBXSecHelper::InFV(start) && UBXSecHelper::InFV(end)) {
-        is_golden = true;
-        break;
       }
     }
   }
-  std::cout << "       is good track? " << is_golden << std::endl;
-  */
+  if (_debug) std::cout << "[UBXSec] Is golden track? " << _is_golden << std::endl;
 
   // Check if truth nu is in FV
   // Collecting GENIE particles
@@ -710,7 +816,7 @@ void UBXSec::analyze(art::Event const & e)
     double truth_nu_vtx[3] = {mclist[iList]->GetNeutrino().Nu().Vx(),
                               mclist[iList]->GetNeutrino().Nu().Vy(),
                               mclist[iList]->GetNeutrino().Nu().Vz()};
-    if (UBXSecHelper::InFV(truth_nu_vtx)) _fv = 1;
+    if (_fiducial_volume.InFV(truth_nu_vtx)) _fv = 1;
     else _fv = 0;
     _ccnc    = mclist[iList]->GetNeutrino().CCNC();
     _nupdg   = mclist[iList]->GetNeutrino().Nu().PdgCode();
@@ -739,63 +845,36 @@ void UBXSec::analyze(art::Event const & e)
   }
 
   // OpHits related 
-  lar_pandora::PFParticlesToSpacePoints pfp_to_spacept;
-  lar_pandora::SpacePointsToHits spacept_to_hits;
-
-  lar_pandora::PFParticleVector temp2;
-  lar_pandora::LArPandoraHelper::CollectPFParticles(e, _pfp_producer, temp2, pfp_to_spacept);
-
-  lar_pandora::SpacePointVector temp3;
-  lar_pandora::LArPandoraHelper::CollectSpacePoints (e, _pfp_producer, temp3, spacept_to_hits);
+  ubxsec::ChargeMomentTable const & charge_moments = pandora_cache.GetPFPChargeMoments();
 
   art::Handle<std::vector<recob::OpHit>> ophit_h;
   e.getByLabel("ophitBeam", ophit_h);
   if(!ophit_h.isValid()) {
     std::cout << "[UBXSec] Cannot locate OpHits." << std::endl;
   }
-  // Save the number of slices in this event
-  std::vector<lar_pandora::TrackVector     > track_v_v;
-  std::vector<lar_pandora::ShowerVector    > shower_v_v;
-  std::vector<lar_pandora::PFParticleVector> pfp_v_v_track;
-  std::vector<lar_pandora::PFParticleVector> pfp_v_v_shower;
-  UBXSecHelper::GetTPCObjects(e, _pfp_producer, pfp_v_v_track, track_v_v);
-  UBXSecHelper::GetTPCObjects(e, _pfp_producer, pfp_v_v_shower, shower_v_v);
-
-  _nslices = pfp_v_v_track.size();
-  _slc_flsmatch_score.resize(_nslices, -9999);
-  _slc_flsmatch_qllx.resize(_nslices, -9999);
-  _slc_flsmatch_tpcx.resize(_nslices, -9999);
-  _slc_flsmatch_t0.resize(_nslices, -9999);
-  _slc_flsmatch_hypoz.resize(_nslices, -9999);
-  _slc_flsmatch_xfixed_chi2.resize(_nslices, -9999);
-  _slc_flsmatch_xfixed_ll.resize(_nslices, -9999);
-  _slc_nuvtx_x.resize(_nslices);
-  _slc_nuvtx_y.resize(_nslices);
-  _slc_nuvtx_z.resize(_nslices);
-  _slc_nuvtx_fv.resize(_nslices);
-  _slc_vtxcheck_angle.resize(_nslices);
-  _slc_origin.resize(_nslices);
-  _slc_flshypo_xfixed_spec.resize(_nslices);
-  _slc_flshypo_spec.resize(_nslices);
-  _slc_nhits_u.resize(_nslices, -9999);
-  _slc_nhits_v.resize(_nslices, -9999);
-  _slc_nhits_w.resize(_nslices, -9999);
-  _slc_flsmatch_cosmic_score.resize(_nslices, -9999);
-  _slc_flsmatch_cosmic_t0.resize(_nslices, -9999);
-  _slc_longesttrack_length.resize(_nslices, -9999);
-  _slc_acpt_outoftime.resize(_nslices, -9999);
-  _slc_crosses_top_boundary.resize(_nslices, -9999);
-  _slc_nuvtx_closetodeadregion_u.resize(_nslices, -9999);
-  _slc_nuvtx_closetodeadregion_v.resize(_nslices, -9999);
-  _slc_nuvtx_closetodeadregion_w.resize(_nslices, -9999);  
-  _slc_kalman_chi2.resize(_nslices, -9999);
-  _slc_kalman_ndof.resize(_nslices, -9999);  
-  _slc_passed_min_track_quality.resize(_nslices, -9999);
-  _slc_n_intime_pe_closestpmt.resize(_nslices, -9999);
-  _slc_maxdistance_vtxtrack.resize(_nslices, -9999);
 
+  // Calibrate the OpHits once, and index them by channel and time for the slices.
+  // OpHits on channels without an OpDet are left out, before the geometry lookup.
+  ubxsec::OpHitIndex ophit_index;
+  if (ophit_h.isValid()) {
+    std::vector<recob::OpHit> ophit_v;
+    std::vector<double> ophit_pe_v;
+    ophit_v.reserve(ophit_h->size());
+    ophit_pe_v.reserve(ophit_h->size());
+    for (auto const & ophit : *ophit_h) {
+      if (ophit.OpChannel() < 0 || !geo->IsValidOpChannel(ophit.OpChannel())) continue;
+      size_t opdet = geo->OpDetFromOpChannel(ophit.OpChannel());
+      ophit_v.emplace_back(ophit);
+      ophit_pe_v.emplace_back(_pecalib.BeamPE(opdet,ophit.Area(),ophit.Amplitude()));
+    }
+    ophit_index.Fill(ophit_v, ophit_pe_v);
+  }
+
+  // Construct the slices (TPC objects), each with its PFPs, tracks, showers and neutrino vertex
+  std::vector<ubana::TPCObjectSlice> slice_v;
+  UBXSecHelper::GetTPCObjects(pandora_cache, slice_v);
 
-  _nslices = pfp_v_v_shower.size();
+  _nslices = slice_v.size();
   _slc_flsmatch_score.resize(_nslices, -9999);
   _slc_flsmatch_qllx.resize(_nslices, -9999);
   _slc_flsmatch_tpcx.resize(_nslices, -9999);
@@ -817,6 +896,7 @@ void UBXSec::analyze(art::Event const & e)
   _slc_flsmatch_cosmic_score.resize(_nslices, -9999);
   _slc_flsmatch_cosmic_t0.resize(_nslices, -9999);
   _slc_longesttrack_length.resize(_nslices, -9999);
+  _slc_longesttrack_deadfraction.resize(_nslices, -9999);
   _slc_acpt_outoftime.resize(_nslices, -9999);
   _slc_crosses_top_boundary.resize(_nslices, -9999);
   _slc_nuvtx_closetodeadregion_u.resize(_nslices, -9999);
@@ -829,252 +909,126 @@ void UBXSec::analyze(art::Event const & e)
   _slc_maxdistance_vtxtrack.resize(_nslices, -9999);
 
   if(_debug) std::cout << "UBXSec - SAVING INFORMATION" << std::endl;
-  _vtx_resolution = -9999;
-  for (unsigned int slice = 0; slice < pfp_v_v_track.size(); slice++){
-    std::cout << ">>> SLICE" << slice << std::endl;
-
-    // Slice origin (0 is neutrino, 1 is cosmic)
-    _slc_origin[slice] = UBXSecHelper::GetSliceOrigin(neutrinoOriginPFP, cosmicOriginPFP, pfp_v_v_track[slice]);
-
-    // Reco vertex
-    double reco_nu_vtx[3];
-    UBXSecHelper::GetNuVertexFromTPCObject(e, _pfp_producer, pfp_v_v_track[slice], reco_nu_vtx);
-    _slc_nuvtx_x[slice] = reco_nu_vtx[0];
-    _slc_nuvtx_y[slice] = reco_nu_vtx[1];
-    _slc_nuvtx_z[slice] = reco_nu_vtx[2];
-    _slc_nuvtx_fv[slice] = (UBXSecHelper::InFV(reco_nu_vtx) ? 1 : 0);
-    std::cout << "    Reco vertex saved" << std::endl;
 
-    // Vertex resolution
-    if (_slc_origin[slice] == 0) {
-      _vtx_resolution = sqrt( pow(_slc_nuvtx_y[slice]-_tvtx_y[0], 2) + pow(_slc_nuvtx_z[slice]-_tvtx_z[0], 2) );
-    } 
+  // Everything the slices read has to be ready before they run concurrently
+  deadRegionsFinder.Prepare();
+  ubxsec::PMTTable::Instance();
+
+  // The art products a slice needs, read here on the module thread: the
+  // slices only see plain values and Ptrs that are already resolved
+  struct SliceInput {
+    size_t n_flash_match = 0;                    ///< Number of neutrino flash matches of the nu PFP
+    double fm_score = -9999, fm_qllx = -9999, fm_tpcx = -9999, fm_t0 = -9999;
+    double fm_xfixed_chi2 = -9999, fm_xfixed_ll = -9999;
+    std::vector<double> fm_hypo_spec;            ///< Hypothesis flash spectrum
+    std::vector<double> fm_xfixed_hypo_spec;     ///< Hypothesis flash spectrum, x fixed
+    std::vector<size_t> acpt_n_flashes;          ///< Number of ACPT flashes, per track
+    std::vector<double> acpt_flash_time;         ///< Time of the ACPT flash, per track (if only one)
+    std::vector<size_t> kalman_n_tracks;         ///< Number of Kalman tracks, per PFP
+    std::vector<size_t> kalman_key;              ///< Kalman track key in kalman_summaries, per PFP (if only one)
+    double nu_vtx[3] = {-9999, -9999, -9999};    ///< Reco neutrino vertex
+    raw::ChannelID_t nu_vtx_channel[3] = {0, 0, 0}; ///< Channel closest to the vertex, per plane
+  };
 
-    // Neutrino Flash match
-    _slc_flsmatch_score[slice] = -9999;
-    art::Ptr<recob::PFParticle> NuPFP = UBXSecHelper::GetNuPFP(pfp_v_v_track[slice]);
-    std::vector<art::Ptr<ubana::FlashMatch>> pfpToFlashMatch_v = pfpToNeutrinoFlashMatchAssns.at(NuPFP.key());
-    if (pfpToFlashMatch_v.size() > 1) {
-      std::cout << "    More than one flash match per nu pfp ?!" << std::endl;
-      continue;
-    } else if (pfpToFlashMatch_v.size() == 0){
-      // do nothing
-    } else {
-      _slc_flsmatch_score[slice]       = pfpToFlashMatch_v[0]->GetScore(); 
-      _slc_flsmatch_qllx[slice]        = pfpToFlashMatch_v[0]->GetEstimatedX();
-      _slc_flsmatch_tpcx[slice]        = pfpToFlashMatch_v[0]->GetTPCX();
-      _slc_flsmatch_t0[slice]          = pfpToFlashMatch_v[0]->GetT0();
-      _slc_flsmatch_hypoz[slice]       = UBXSecHelper::GetFlashZCenter(pfpToFlashMatch_v[0]->GetHypoFlashSpec());
-      _slc_flsmatch_xfixed_chi2[slice] = pfpToFlashMatch_v[0]->GetXFixedChi2();
-      _slc_flsmatch_xfixed_ll[slice]   = pfpToFlashMatch_v[0]->GetXFixedLl();
-      _slc_flshypo_xfixed_spec[slice]  = pfpToFlashMatch_v[0]->GetXFixedHypoFlashSpec();
-      _slc_flshypo_spec[slice]         = pfpToFlashMatch_v[0]->GetHypoFlashSpec();
-      for (auto v : _slc_flshypo_spec[slice]) std::cout << "PE: " << v << std::endl;
-
-      std::cout << "    FM score: " << _slc_flsmatch_score[slice] << std::endl;
-    }
+  std::vector<SliceInput> slice_input(_nslices);
+  for (unsigned int slice = 0; slice < slice_v.size(); slice++) {
 
-    // Cosmic Flash Match
-    _slc_flsmatch_cosmic_score[slice] = -9999;
-    /*
-    std::vector<art::Ptr<ubana::FlashMatch>> pfpToCosmicFlashMatch_v = pfpToCosmicFlashMatchAssns.at(NuPFP.key());
-    if (pfpToCosmicFlashMatch_v.size() > 1) {
-      std::cout << "    More than one flash match per nu pfp!" << std::endl;
-      continue;
-    } else if (pfpToCosmicFlashMatch_v.size() == 0){
-      std::cout << "    PFP to flash match ass for cosmic is zero." << std::endl;
-      //continue;
-    } else if (pfpToCosmicFlashMatch_v.size() == 1){
-      //std::cout << "pfpToCosmicFlashMatch_v[0]->GetScore() is " << pfpToCosmicFlashMatch_v[0]->GetScore() << std::endl;
-      //std::cout << "pfpToCosmicFlashMatch_v[0]->GetT0() is " << pfpToCosmicFlashMatch_v[0]->GetT0() << std::endl;
-      _slc_flsmatch_cosmic_score[slice] = pfpToCosmicFlashMatch_v[0]->GetScore();
-      _slc_flsmatch_cosmic_t0[slice]    = pfpToCosmicFlashMatch_v[0]->GetT0();
-    } else {
-      std::cout << "    I don't know what fucking case this is." << std::endl;
-    }
-    */
+    ubana::TPCObjectSlice const & tpcobj = slice_v[slice];
+    SliceInput & in = slice_input[slice];
 
-    // Hits
-    int nhits_u, nhits_v, nhits_w;
-    UBXSecHelper::GetNumberOfHitsPerPlane(e, _pfp_producer, track_v_v[slice], nhits_u, nhits_v, nhits_w);
-    _slc_nhits_u[slice] = nhits_u;
-    _slc_nhits_v[slice] = nhits_v;
-    _slc_nhits_w[slice] = nhits_w;
+    for (auto const & pfp : tpcobj.pfp_v)    pfp.get();
+    for (auto const & trk : tpcobj.track_v)  trk.get();
+    for (auto const & shw : tpcobj.shower_v) shw.get();
+    tpcobj.nu_pfp.get();
 
-    // Longest track and check boundary
-    recob::Track lt;
-    if (UBXSecHelper::GetLongestTrackFromTPCObj(track_v_v[slice], lt)){
-      _slc_longesttrack_length[slice] = lt.Length();
-      int vtx_ok;
-      _slc_crosses_top_boundary[slice] = (UBXSecHelper::IsCrossingTopBoundary(lt, vtx_ok) ? 1 : 0);
-    } else {
-      _slc_longesttrack_length[slice] = -9999;
+    if (!tpcobj.nu_vertex.isNull()) tpcobj.nu_vertex->XYZ(in.nu_vtx);
+    for (int plane = 0; plane < 3; plane++) {
+      in.nu_vtx_channel[plane] = UBXSecHelper::NearestChannel(in.nu_vtx, plane, deadRegionsFinder);
     }
 
-    // ACPT
-    _slc_acpt_outoftime[slice] = 0;
-    for (unsigned int t = 0; t < track_v_v[slice].size(); t++) {
-      if(opfls_ptr_coll_v.at(track_v_v[slice][t].key()).size()>1) {
-        std::cout << "[UBXSec] More than 1 association found (ACPT)!" << std::endl;
-        //throw std::exception();
-      } else if (opfls_ptr_coll_v.at(track_v_v[slice][t].key()).size()==0){
-        continue;
-      } else {
-        art::Ptr<recob::OpFlash> flash_ptr = opfls_ptr_coll_v.at(track_v_v[slice][t].key()).at(0);
-        if (flash_ptr->Time() < _beam_spill_start || flash_ptr->Time() > _beam_spill_end) {
-          _slc_acpt_outoftime[slice] = 1;
-        }
-      }
+    std::vector<art::Ptr<ubana::FlashMatch>> pfpToFlashMatch_v = pfpToNeutrinoFlashMatchAssns.at(tpcobj.nu_pfp.key());
+    in.n_flash_match = pfpToFlashMatch_v.size();
+    if (in.n_flash_match == 1) {
+      ubana::FlashMatch const & fm = *(pfpToFlashMatch_v[0]);
+      in.fm_score            = fm.GetScore();
+      in.fm_qllx             = fm.GetEstimatedX();
+      in.fm_tpcx             = fm.GetTPCX();
+      in.fm_t0               = fm.GetT0();
+      in.fm_xfixed_chi2      = fm.GetXFixedChi2();
+      in.fm_xfixed_ll        = fm.GetXFixedLl();
+      in.fm_hypo_spec        = fm.GetHypoFlashSpec();
+      in.fm_xfixed_hypo_spec = fm.GetXFixedHypoFlashSpec();
     }
 
-    // Track quality
-    _slc_kalman_chi2[slice] = -9999;
-    for (unsigned int t = 0; t < pfp_v_v_track[slice].size(); t++) {
-      if(trk_kalman_v.at(pfp_v_v_track[slice][t].key()).size()>1) {
-        std::cout << "[UBXSec] TQ more than one track per PFP, ntracks " << trk_kalman_v.at(pfp_v_v_track[slice][t].key()).size() << std::endl;
-      } else if (trk_kalman_v.at(pfp_v_v_track[slice][t].key()).size()==0){
-        continue;
-      } else {
-        art::Ptr<recob::Track> trk_ptr = trk_kalman_v.at(pfp_v_v_track[slice][t].key()).at(0);
-        _slc_kalman_chi2[slice] = trk_ptr->Chi2();
-        _slc_kalman_ndof[slice] = trk_ptr->Ndof();
-      }
+    in.acpt_n_flashes.resize(tpcobj.track_v.size(), 0);
+    in.acpt_flash_time.resize(tpcobj.track_v.size(), -9999);
+    for (unsigned int t = 0; t < tpcobj.track_v.size(); t++) {
+      std::vector<art::Ptr<recob::OpFlash>> const & flash_v = opfls_ptr_coll_v.at(tpcobj.track_v[t].key());
+      in.acpt_n_flashes[t] = flash_v.size();
+      if (flash_v.size() == 1) in.acpt_flash_time[t] = flash_v[0]->Time();
     }
-    bool goodTrack = false;
-    for (auto trk : track_v_v[slice]) {
-      if (!deadRegionsFinder.NearDeadReg2P( (trk->Vertex()).Y(), (trk->Vertex()).Z(), 0.6 )  &&
-          !deadRegionsFinder.NearDeadReg2P( (trk->End()).Y(),    (trk->End()).Z(),    0.6 )  &&
-          UBXSecHelper::TrackPassesHitRequirment(e, _pfp_producer, trk, _minimumHitRequirement) ) {
-        goodTrack = true;
-        continue;
-      }
-    }
-    if (goodTrack) _slc_passed_min_track_quality[slice] = true;
-    else _slc_passed_min_track_quality[slice] = false;
-
-    // Channel status
-    _slc_nuvtx_closetodeadregion_u[slice] = (UBXSecHelper::PointIsCloseToDeadRegion(reco_nu_vtx, 0) ? 1 : 0);
-    _slc_nuvtx_closetodeadregion_v[slice] = (UBXSecHelper::PointIsCloseToDeadRegion(reco_nu_vtx, 1) ? 1 : 0);
-    _slc_nuvtx_closetodeadregion_w[slice] = (UBXSecHelper::PointIsCloseToDeadRegion(reco_nu_vtx, 2) ? 1 : 0);
 
-    // Vertex check
-    recob::Vertex slice_vtx;
-    UBXSecHelper::GetNuVertexFromTPCObject(e, _pfp_producer, pfp_v_v_track[slice], slice_vtx);
-    ubxsec::VertexCheck vtxCheck(track_v_v[slice], slice_vtx);
-    _slc_vtxcheck_angle[slice] = vtxCheck.AngleBetweenLongestTracks();
-    
-    // OpHits
-    std::vector<ubxsec::Hit3D_t> hit3d_v;
-    hit3d_v.clear();
-    for (auto pfp : pfp_v_v_track[slice]) {
-      auto iter = pfp_to_spacept.find(pfp);
-      if (iter != pfp_to_spacept.end()) {
-        //std::cout << "[UBXSec] Found related spacepoints, size is " << (iter->second).size() << std::endl;
-      } else {
-        std::cout << "[UBXSec] Can't find spacepoints for pfp with pdg " << pfp->PdgCode() << std::endl;
-        continue;
-      }
-      // Loop through the hits associated 
-      for (auto sp_pt : (iter->second)) {
-        auto iter2 = spacept_to_hits.find(sp_pt);
-        if (iter2 != spacept_to_hits.end()) {
-          //std::cout << "[UBXSec] Founds hits associated to this sp_pt" << std::endl;
-        } else {
-          std::cout << "[UBXSec] Can't find hits ass to this sp_pt" << std::endl;
-          continue;
-        }   
-        // Save sp_pt position and hit charge for all the sp_pt you have
-        auto hit = iter2->second;
-        ubxsec::Hit3D_t thishit;
-        thishit.x = sp_pt->XYZ()[0];
-        thishit.y = sp_pt->XYZ()[1];
-        thishit.z = sp_pt->XYZ()[2];
-        thishit.q = hit->Integral();
-        hit3d_v.emplace_back(thishit);
+    in.kalman_n_tracks.resize(tpcobj.pfp_v.size(), 0);
+    in.kalman_key.resize(tpcobj.pfp_v.size(), 0);
+    for (unsigned int t = 0; t < tpcobj.pfp_v.size(); t++) {
+      std::vector<art::Ptr<recob::Track>> const & trk_v = trk_kalman_v.at(tpcobj.pfp_v[t].key());
+      in.kalman_n_tracks[t] = trk_v.size();
+      if (trk_v.size() == 1) {
+        in.kalman_key[t] = trk_v[0].key();
       }
     }
-    std::cout << "[UBXSec] For this TPC object we have " << hit3d_v.size() << " Hit3D_t hits." << std::endl;
-
-    // Now construct average position
-    double sumx = 0, sumy = 0, sumz = 0;
-    double totq = 0;
-    for (auto hit3d : hit3d_v) {
-      sumx += hit3d.q * hit3d.x;
-      sumy += hit3d.q * hit3d.y;
-      sumz += hit3d.q * hit3d.z;
-      
-      totq += hit3d.q; 
-    }
-    double charge_center[3] = {sumx / totq, sumy / totq, sumz / totq};
-
-    int this_opch = UBXSecHelper::GetClosestPMT(charge_center);
-
-    // Look at the opHits from this pmt
-    int n_intime_ophits = 0;
-    double n_intime_pe = 0;
-    for (size_t oh = 0; oh < ophit_h->size(); oh++) {
-      auto const & ophit = (*ophit_h)[oh];
-      if (ophit.OpChannel() != this_opch) continue;
-      if (ophit.PeakTime() > _beam_spill_start && ophit.PeakTime() < _beam_spill_end) {
-        n_intime_ophits ++;
-        size_t opdet = geo->OpDetFromOpChannel(ophit.OpChannel());
-        n_intime_pe += _pecalib.BeamPE(opdet,ophit.Area(),ophit.Amplitude());
-      }     
-    } // end loop ophit
-
-    _slc_n_intime_pe_closestpmt[slice] = n_intime_pe;
-
-
-    // Distance from recon nu vertex to thefar away track in TPCObject
-    //_slc_maxdistance_vtxtrack = UBXSecHelper::GetMaxTrackVertexDistance();
-
+  }
 
-    std::cout << "UBXSec - INFORMATION SAVED" << std::endl;
-  } // slice loop
+  // Outputs that more than one slice would write (or std::vector<bool> entries,
+  // which share memory), merged in slice order after the slice loop
+  std::vector<double> slice_vtx_resolution(_nslices, -9999);
+  std::vector<char>   slice_vtx_resolution_set(_nslices, 0);
+  std::vector<int>    slice_min_track_quality(_nslices, -1);
 
+  // Each slice only writes its own entry of the _slc_ vectors
+  auto analyze_slice = [&](unsigned int slice, std::ostream & log) {
+    log << ">>> SLICE" << slice << std::endl;
 
-  for (unsigned int slice = 0; slice < pfp_v_v_shower.size(); slice++){
-    std::cout << ">>> SLICE" << slice << std::endl;
+    ubana::TPCObjectSlice const & tpcobj = slice_v[slice];
+    SliceInput const & in = slice_input[slice];
 
     // Slice origin (0 is neutrino, 1 is cosmic)
-    _slc_origin[slice] = UBXSecHelper::GetSliceOrigin(neutrinoOriginPFP, cosmicOriginPFP, pfp_v_v_shower[slice]);
+    _slc_origin[slice] = UBXSecHelper::GetSliceOrigin(neutrinoOriginPFP, cosmicOriginPFP, tpcobj.pfp_v);
 
     // Reco vertex
-    double reco_nu_vtx[3];
-    UBXSecHelper::GetNuVertexFromTPCObject(e, _pfp_producer, pfp_v_v_shower[slice], reco_nu_vtx);
+    double reco_nu_vtx[3] = {in.nu_vtx[0], in.nu_vtx[1], in.nu_vtx[2]};
     _slc_nuvtx_x[slice] = reco_nu_vtx[0];
     _slc_nuvtx_y[slice] = reco_nu_vtx[1];
     _slc_nuvtx_z[slice] = reco_nu_vtx[2];
-    _slc_nuvtx_fv[slice] = (UBXSecHelper::InFV(reco_nu_vtx) ? 1 : 0);
-    std::cout << "    Reco vertex saved" << std::endl;
+    _slc_nuvtx_fv[slice] = (_fiducial_volume.InFV(reco_nu_vtx) ? 1 : 0);
+    log << "    Reco vertex saved" << std::endl;
 
     // Vertex resolution
     if (_slc_origin[slice] == 0) {
-      _vtx_resolution = sqrt( pow(_slc_nuvtx_y[slice]-_tvtx_y[0], 2) + pow(_slc_nuvtx_z[slice]-_tvtx_z[0], 2) );
+      slice_vtx_resolution[slice] = sqrt( pow(_slc_nuvtx_y[slice]-_tvtx_y[0], 2) + pow(_slc_nuvtx_z[slice]-_tvtx_z[0], 2) );
+      slice_vtx_resolution_set[slice] = 1;
     } 
 
     // Neutrino Flash match
     _slc_flsmatch_score[slice] = -9999;
-    art::Ptr<recob::PFParticle> NuPFP = UBXSecHelper::GetNuPFP(pfp_v_v_shower[slice]);
-    std::vector<art::Ptr<ubana::FlashMatch>> pfpToFlashMatch_v = pfpToNeutrinoFlashMatchAssns.at(NuPFP.key());
-    if (pfpToFlashMatch_v.size() > 1) {
-      std::cout << "    More than one flash match per nu pfp ?!" << std::endl;
-      continue;
-    } else if (pfpToFlashMatch_v.size() == 0){
+    if (in.n_flash_match > 1) {
+      log << "    More than one flash match per nu pfp ?!" << std::endl;
+      return;
+    } else if (in.n_flash_match == 0){
       // do nothing
     } else {
-      _slc_flsmatch_score[slice]       = pfpToFlashMatch_v[0]->GetScore(); 
-      _slc_flsmatch_qllx[slice]        = pfpToFlashMatch_v[0]->GetEstimatedX();
-      _slc_flsmatch_tpcx[slice]        = pfpToFlashMatch_v[0]->GetTPCX();
-      _slc_flsmatch_t0[slice]          = pfpToFlashMatch_v[0]->GetT0();
-      _slc_flsmatch_hypoz[slice]       = UBXSecHelper::GetFlashZCenter(pfpToFlashMatch_v[0]->GetHypoFlashSpec());
-      _slc_flsmatch_xfixed_chi2[slice] = pfpToFlashMatch_v[0]->GetXFixedChi2();
-      _slc_flsmatch_xfixed_ll[slice]   = pfpToFlashMatch_v[0]->GetXFixedLl();
-      _slc_flshypo_xfixed_spec[slice]  = pfpToFlashMatch_v[0]->GetXFixedHypoFlashSpec();
-      _slc_flshypo_spec[slice]         = pfpToFlashMatch_v[0]->GetHypoFlashSpec();
-      for (auto v : _slc_flshypo_spec[slice]) std::cout << "PE: " << v << std::endl;
-
-      std::cout << "    FM score: " << _slc_flsmatch_score[slice] << std::endl;
+      _slc_flsmatch_score[slice]       = in.fm_score;
+      _slc_flsmatch_qllx[slice]        = in.fm_qllx;
+      _slc_flsmatch_tpcx[slice]        = in.fm_tpcx;
+      _slc_flsmatch_t0[slice]          = in.fm_t0;
+      _slc_flsmatch_hypoz[slice]       = UBXSecHelper::GetFlashZCenter(in.fm_hypo_spec);
+      _slc_flsmatch_xfixed_chi2[slice] = in.fm_xfixed_chi2;
+      _slc_flsmatch_xfixed_ll[slice]   = in.fm_xfixed_ll;
+      _slc_flshypo_xfixed_spec[slice]  = in.fm_xfixed_hypo_spec;
+      _slc_flshypo_spec[slice]         = in.fm_hypo_spec;
+      for (auto v : _slc_flshypo_spec[slice]) log << "PE: " << v << std::endl;
+
+      log << "    FM score: " << _slc_flsmatch_score[slice] << std::endl;
     }
 
     // Cosmic Flash Match
@@ -1082,172 +1036,172 @@ void UBXSec::analyze(art::Event const & e)
     /*
     std::vector<art::Ptr<ubana::FlashMatch>> pfpToCosmicFlashMatch_v = pfpToCosmicFlashMatchAssns.at(NuPFP.key());
     if (pfpToCosmicFlashMatch_v.size() > 1) {
-      std::cout << "    More than one flash match per nu pfp!" << std::endl;
+      log << "    More than one flash match per nu pfp!" << std::endl;
       continue;
     } else if (pfpToCosmicFlashMatch_v.size() == 0){
-      std::cout << "    PFP to flash match ass for cosmic is zero." << std::endl;
+      log << "    PFP to flash match ass for cosmic is zero." << std::endl;
       //continue;
     } else if (pfpToCosmicFlashMatch_v.size() == 1){
-      //std::cout << "pfpToCosmicFlashMatch_v[0]->GetScore() is " << pfpToCosmicFlashMatch_v[0]->GetScore() << std::endl;
-      //std::cout << "pfpToCosmicFlashMatch_v[0]->GetT0() is " << pfpToCosmicFlashMatch_v[0]->GetT0() << std::endl;
+      //log << "pfpToCosmicFlashMatch_v[0]->GetScore() is " << pfpToCosmicFlashMatch_v[0]->GetScore() << std::endl;
+      //log << "pfpToCosmicFlashMatch_v[0]->GetT0() is " << pfpToCosmicFlashMatch_v[0]->GetT0() << std::endl;
       _slc_flsmatch_cosmic_score[slice] = pfpToCosmicFlashMatch_v[0]->GetScore();
       _slc_flsmatch_cosmic_t0[slice]    = pfpToCosmicFlashMatch_v[0]->GetT0();
     } else {
-      std::cout << "    I don't know what fucking case this is." << std::endl;
+      log << "    I don't know what fucking case this is." << std::endl;
     }
     */
 
-    // Hits
+    // Hits (tracks and showers)
     int nhits_u, nhits_v, nhits_w;
-    UBXSecHelper::GetNumberOfHitsPerPlane(e, _pfp_producer, shower_v_v[slice], nhits_u, nhits_v, nhits_w);
-    _slc_nhits_u[slice] = nhits_u;
-    _slc_nhits_v[slice] = nhits_v;
-    _slc_nhits_w[slice] = nhits_w;
+    int nshwhits_u, nshwhits_v, nshwhits_w;
+    UBXSecHelper::GetNumberOfHitsPerPlane(pandora_cache, tpcobj.track_v, nhits_u, nhits_v, nhits_w);
+    UBXSecHelper::GetNumberOfHitsPerPlane(pandora_cache, tpcobj.shower_v, nshwhits_u, nshwhits_v, nshwhits_w);
+    _slc_nhits_u[slice] = nhits_u + nshwhits_u;
+    _slc_nhits_v[slice] = nhits_v + nshwhits_v;
+    _slc_nhits_w[slice] = nhits_w + nshwhits_w;
 
-    /*
     // Longest track and check boundary
-    recob::Shower lt;
-    if (UBXSecHelper::GetLongestTrackFromTPCObj(shower_v_v[slice], lt)){
-      _slc_longesttrack_length[slice] = lt.Length();
+    art::Ptr<recob::Track> lt;
+    if (UBXSecHelper::GetLongestTrackFromTPCObj(track_summaries, tpcobj.track_v, lt)){
+      _slc_longesttrack_length[slice] = track_summaries.Length(lt);
+      _slc_longesttrack_deadfraction[slice] = deadRegionsFinder.GetDeadPathLength(*lt, 0.6).DeadFraction2P();
       int vtx_ok;
-      _slc_crosses_top_boundary[slice] = (UBXSecHelper::IsCrossingTopBoundary(lt, vtx_ok) ? 1 : 0);
+      _slc_crosses_top_boundary[slice] = (UBXSecHelper::IsCrossingTopBoundary(_fiducial_volume, track_summaries, lt, vtx_ok, log) ? 1 : 0);
     } else {
       _slc_longesttrack_length[slice] = -9999;
+      _slc_longesttrack_deadfraction[slice] = -9999;
     }
-    */
 
-    /*
     // ACPT
     _slc_acpt_outoftime[slice] = 0;
-    for (unsigned int t = 0; t < track_v_v[slice].size(); t++) {
-      if(opfls_ptr_coll_v.at(track_v_v[slice][t].key()).size()>1) {
-        std::cout << "[UBXSec] More than 1 association found (ACPT)!" << std::endl;
+    for (unsigned int t = 0; t < tpcobj.track_v.size(); t++) {
+      if(in.acpt_n_flashes[t]>1) {
+        log << "[UBXSec] More than 1 association found (ACPT)!" << std::endl;
         //throw std::exception();
-      } else if (opfls_ptr_coll_v.at(track_v_v[slice][t].key()).size()==0){
+      } else if (in.acpt_n_flashes[t]==0){
         continue;
       } else {
-        art::Ptr<recob::OpFlash> flash_ptr = opfls_ptr_coll_v.at(track_v_v[slice][t].key()).at(0);
-        if (flash_ptr->Time() < _beam_spill_start || flash_ptr->Time() > _beam_spill_end) {
+        if (in.acpt_flash_time[t] < _beam_spill_start || in.acpt_flash_time[t] > _beam_spill_end) {
           _slc_acpt_outoftime[slice] = 1;
         }
       }
     }
-    */
-    /*
+
     // Track quality
     _slc_kalman_chi2[slice] = -9999;
-    for (unsigned int t = 0; t < pfp_v_v_track[slice].size(); t++) {
-      if(trk_kalman_v.at(pfp_v_v_track[slice][t].key()).size()>1) {
-        std::cout << "[UBXSec] TQ more than one track per PFP, ntracks " << trk_kalman_v.at(pfp_v_v_track[slice][t].key()).size() << std::endl;
-      } else if (trk_kalman_v.at(pfp_v_v_track[slice][t].key()).size()==0){
+    for (unsigned int t = 0; t < tpcobj.pfp_v.size(); t++) {
+      if(in.kalman_n_tracks[t]>1) {
+        log << "[UBXSec] TQ more than one track per PFP, ntracks " << in.kalman_n_tracks[t] << std::endl;
+      } else if (in.kalman_n_tracks[t]==0){
         continue;
       } else {
-        art::Ptr<recob::Track> trk_ptr = trk_kalman_v.at(pfp_v_v_track[slice][t].key()).at(0);
-        _slc_kalman_chi2[slice] = trk_ptr->Chi2();
-        _slc_kalman_ndof[slice] = trk_ptr->Ndof();
+        _slc_kalman_chi2[slice] = kalman_summaries.Chi2(in.kalman_key[t]);
+        _slc_kalman_ndof[slice] = kalman_summaries.Ndof(in.kalman_key[t]);
       }
     }
     bool goodTrack = false;
-    for (auto trk : track_v_v[slice]) {
+    for (auto trk : tpcobj.track_v) {
       if (!deadRegionsFinder.NearDeadReg2P( (trk->Vertex()).Y(), (trk->Vertex()).Z(), 0.6 )  &&
           !deadRegionsFinder.NearDeadReg2P( (trk->End()).Y(),    (trk->End()).Z(),    0.6 )  &&
-          UBXSecHelper::TrackPassesHitRequirment(e, _pfp_producer, trk, _minimumHitRequirement) ) {
+          UBXSecHelper::TrackPassesHitRequirment(pandora_cache, trk, _minimumHitRequirement) ) {
         goodTrack = true;
         continue;
       }
     }
-    if (goodTrack) _slc_passed_min_track_quality[slice] = true;
-    else _slc_passed_min_track_quality[slice] = false;
-    */
+    slice_min_track_quality[slice] = (goodTrack ? 1 : 0);
 
     // Channel status
-    _slc_nuvtx_closetodeadregion_u[slice] = (UBXSecHelper::PointIsCloseToDeadRegion(reco_nu_vtx, 0) ? 1 : 0);
-    _slc_nuvtx_closetodeadregion_v[slice] = (UBXSecHelper::PointIsCloseToDeadRegion(reco_nu_vtx, 1) ? 1 : 0);
-    _slc_nuvtx_closetodeadregion_w[slice] = (UBXSecHelper::PointIsCloseToDeadRegion(reco_nu_vtx, 2) ? 1 : 0);
+    _slc_nuvtx_closetodeadregion_u[slice] = (deadRegionsFinder.ChannelNearBadChannel(in.nu_vtx_channel[0], _dead_ch_window) ? 1 : 0);
+    _slc_nuvtx_closetodeadregion_v[slice] = (deadRegionsFinder.ChannelNearBadChannel(in.nu_vtx_channel[1], _dead_ch_window) ? 1 : 0);
+    _slc_nuvtx_closetodeadregion_w[slice] = (deadRegionsFinder.ChannelNearBadChannel(in.nu_vtx_channel[2], _dead_ch_window) ? 1 : 0);
 
     // Vertex check
     recob::Vertex slice_vtx;
-    UBXSecHelper::GetNuVertexFromTPCObject(e, _pfp_producer, pfp_v_v_shower[slice], slice_vtx);
-    ubxsec::VertexCheck vtxCheck(shower_v_v[slice], slice_vtx);
-    //_slc_vtxcheck_angle[slice] = vtxCheck.AngleBetweenLongestTracks();
+    if (!tpcobj.nu_vertex.isNull()) slice_vtx = *(tpcobj.nu_vertex);
+    ubxsec::VertexCheck vtxCheck(tpcobj.track_v, slice_vtx);
+    vtxCheck.SetTrackSummaries(&track_summaries);
+    _slc_vtxcheck_angle[slice] = vtxCheck.AngleBetweenLongestTracks();
     
-    // OpHits
-    std::vector<ubxsec::Hit3D_t> hit3d_v;
-    hit3d_v.clear();
-    for (auto pfp : pfp_v_v_shower[slice]) {
-      auto iter = pfp_to_spacept.find(pfp);
-      if (iter != pfp_to_spacept.end()) {
-        //std::cout << "[UBXSec] Found related spacepoints, size is " << (iter->second).size() << std::endl;
-      } else {
-        if(_debug) std::cout << "[UBXSec] Can't find spacepoints for pfp with pdg " << pfp->PdgCode() << std::endl;
+    // Charge center of the slice, from the charge moments of its PFPs
+    ubxsec::ChargeMoments slice_moments;
+    for (auto pfp : tpcobj.pfp_v) {
+      if (!charge_moments.Has(pfp.key())) {
+        log << "[UBXSec] Can't find spacepoints for pfp with pdg " << pfp->PdgCode() << std::endl;
         continue;
       }
-      // Loop through the hits associated 
-      for (auto sp_pt : (iter->second)) {
-        auto iter2 = spacept_to_hits.find(sp_pt);
-        if (iter2 != spacept_to_hits.end()) {
-          //std::cout << "[UBXSec] Founds hits associated to this sp_pt" << std::endl;
-        } else {
-          if(_debug) std::cout << "[UBXSec] Can't find hits ass to this sp_pt" << std::endl;
-          continue;
-        }   
-        // Save sp_pt position and hit charge for all the sp_pt you have
-        auto hit = iter2->second;
-        ubxsec::Hit3D_t thishit;
-        thishit.x = sp_pt->XYZ()[0];
-        thishit.y = sp_pt->XYZ()[1];
-        thishit.z = sp_pt->XYZ()[2];
-        thishit.q = hit->Integral();
-        hit3d_v.emplace_back(thishit);
-      }
-    }
-    std::cout << "[UBXSec] For this TPC object we have " << hit3d_v.size() << " Hit3D_t hits." << std::endl;
-
-    // Now construct average position
-    double sumx = 0, sumy = 0, sumz = 0;
-    double totq = 0;
-    for (auto hit3d : hit3d_v) {
-      sumx += hit3d.q * hit3d.x;
-      sumy += hit3d.q * hit3d.y;
-      sumz += hit3d.q * hit3d.z;
-      
-      totq += hit3d.q; 
+      slice_moments += charge_moments.Get(pfp.key());
     }
-    double charge_center[3] = {sumx / totq, sumy / totq, sumz / totq};
+    log << "[UBXSec] For this TPC object we have " << slice_moments.n_points << " spacepoints with a hit." << std::endl;
+
+    double charge_center[3];
+    slice_moments.Center(charge_center);
 
     int this_opch = UBXSecHelper::GetClosestPMT(charge_center);
 
     // Look at the opHits from this pmt
-    int n_intime_ophits = 0;
-    double n_intime_pe = 0;
-    for (size_t oh = 0; oh < ophit_h->size(); oh++) {
-      auto const & ophit = (*ophit_h)[oh];
-      if (ophit.OpChannel() != this_opch) continue;
-      if (ophit.PeakTime() > _beam_spill_start && ophit.PeakTime() < _beam_spill_end) {
-        n_intime_ophits ++;
-        size_t opdet = geo->OpDetFromOpChannel(ophit.OpChannel());
-        n_intime_pe += _pecalib.BeamPE(opdet,ophit.Area(),ophit.Amplitude());
-      }     
-    } // end loop ophit
-
-    _slc_n_intime_pe_closestpmt[slice] = n_intime_pe;
-
-
-    // Distance from reco nu vertex to thefar away track in TPCObject
+    _slc_n_intime_pe_closestpmt[slice] = ophit_index.PE(this_opch, _beam_spill_start, _beam_spill_end);
+
+
+    // Distance from recon nu vertex to thefar away track in TPCObject
     //_slc_maxdistance_vtxtrack = UBXSecHelper::GetMaxTrackVertexDistance();
 
 
-    std::cout << "UBXSec - INFORMATION SAVED" << std::endl;
-  } // slice loop
+    log << "UBXSec - INFORMATION SAVED" << std::endl;
+  };
 
+  int n_threads = _n_slice_threads;
+  if (n_threads <= 0) n_threads = std::thread::hardware_concurrency();
+  if (n_threads <= 0) n_threads = 1;
+  n_threads = std::min(n_threads, _nslices);
 
+  if (n_threads <= 1) {
 
-  /* Dead regions
-  //art::ServiceHandle<FindDeadRegions> deadRegionsFinder;
-  FindDeadRegions deadRegionsFinder;
-  deadRegionsFinder.GetDeadRegionHisto2P(_deadRegion2P);
-  deadRegionsFinder.GetDeadRegionHisto3P(_deadRegion3P);
-  */
+    for (unsigned int slice = 0; slice < slice_v.size(); slice++){
+      analyze_slice(slice, std::cout);
+    }
+
+  } else {
+
+    // Slices have very different sizes, so threads take the next slice
+    // from a shared counter. Logs are buffered and printed in slice order.
+    std::vector<std::ostringstream> slice_log(_nslices);
+    std::vector<std::exception_ptr> slice_exception(_nslices);
+    std::atomic<unsigned int> next_slice(0);
+
+    auto run_slices = [&]() {
+      for (unsigned int slice = next_slice++; slice < slice_v.size(); slice = next_slice++) {
+        try {
+          analyze_slice(slice, slice_log[slice]);
+        } catch (...) {
+          slice_exception[slice] = std::current_exception();
+        }
+      }
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < n_threads; t++) workers.emplace_back(run_slices);
+    for (auto & w : workers) w.join();
+
+    for (unsigned int slice = 0; slice < slice_v.size(); slice++) {
+      std::cout << slice_log[slice].str();
+      if (slice_exception[slice]) std::rethrow_exception(slice_exception[slice]);
+    }
+  }
+
+  // Merge, as the serial loop would have written them
+  _vtx_resolution = -9999;
+  for (unsigned int slice = 0; slice < slice_v.size(); slice++) {
+    if (slice_vtx_resolution_set[slice]) _vtx_resolution = slice_vtx_resolution[slice];
+    if (slice_min_track_quality[slice] >= 0) _slc_passed_min_track_quality[slice] = (slice_min_track_quality[slice] == 1);
+  }
+
+  // Dead regions, only filled once per job
+  if (_save_dead_region_histos && !_dead_region_histos_filled) {
+    std::lock_guard<std::mutex> io_lock(ubxsec::TreeIOMutex());
+    deadRegionsFinder.GetDeadRegionHisto2P(_deadRegion2P);
+    deadRegionsFinder.GetDeadRegionHisto3P(_deadRegion3P);
+    _dead_region_histos_filled = true;
+  }
 
   // Flashes
   ::art::Handle<std::vector<recob::OpFlash>> beamflash_h;
@@ -1379,7 +1333,9 @@ void UBXSec::analyze(art::Event const & e)
 
 
   if(_debug) std::cout << "[UBXSec] Filling tree now." << std::endl;
-  _tree1->Fill();
+  // The flat trees only read the members, they can be set while _tree1 is filled
+  if (_write_nested_tree) _tree_filler.Fill();
+  if (_write_flat_trees) FillFlatTrees();
 
   if(_debug) std::cout << "********** UBXSec ends" << std::endl;
 
@@ -1388,4 +1344,124 @@ void UBXSec::analyze(art::Event const & e)
 
 
 
+//___________________________________________________________________________________________________
+void UBXSec::FillFlatTrees() {
+
+  // Entries are counted here, the tree may still be writing the previous ones
+  Long64_t event_entry = _n_flat_events++;
+
+  // Event
+  ubxsec::FlatEventRecord & flat_event = _flat_event_writer.Get();
+  flat_event.run                        = _run;
+  flat_event.subrun                     = _subrun;
+  flat_event.event                      = _event;
+  flat_event.is_reco                    = _is_reco;
+  flat_event.reco_purity                = _reco_pur;
+  flat_event.reco_efficiency            = _reco_eff;
+  flat_event.true_momentum              = _true_mom;
+  flat_event.true_momentum_matched      = _true_mom_matched;
+  flat_event.nPFPtagged                 = _nPFPtagged;
+  flat_event.is_flash_tagged            = _is_flash_tagged;
+  flat_event.tag_score                  = _tag_score;
+  flat_event.fm_score                   = _fm_score;
+  flat_event.fv                         = _fv;
+  flat_event.ccnc                       = _ccnc;
+  flat_event.nupdg                      = _nupdg;
+  flat_event.nu_e                       = _nu_e;
+  flat_event.reco_start_x               = _reco_start_x;
+  flat_event.reco_start_y               = _reco_start_y;
+  flat_event.reco_start_z               = _reco_start_z;
+  flat_event.reco_end_x                 = _reco_end_x;
+  flat_event.reco_end_y                 = _reco_end_y;
+  flat_event.reco_end_z                 = _reco_end_z;
+  flat_event.mc_start_x                 = _mc_start_x;
+  flat_event.mc_start_y                 = _mc_start_y;
+  flat_event.mc_start_z                 = _mc_start_z;
+  flat_event.mc_end_x                   = _mc_end_x;
+  flat_event.mc_end_y                   = _mc_end_y;
+  flat_event.mc_end_z                   = _mc_end_z;
+  flat_event.mc_contained               = _mc_contained;
+  flat_event.is_golden                  = _is_golden;
+  flat_event.is_swtriggered             = _is_swtriggered;
+  flat_event.vtx_resolution             = _vtx_resolution;
+  flat_event.nslices                    = _nslices;
+  flat_event.nbeamfls                   = _nbeamfls;
+  flat_event.nsignal                    = _nsignal;
+  flat_event.no_mcflash_but_op_activity = _no_mcflash_but_op_activity;
+  ubxsec::FillFlatSpec(_numc_flash_spec, flat_event.numc_flash_spec);
+  _flat_event_writer.Commit();
+
+  // Slices
+  for (int slice = 0; slice < _nslices; slice++) {
+    ubxsec::FlatSliceRecord & flat_slice = _flat_slice_writer.Get();
+    flat_slice.event_entry               = event_entry;
+    flat_slice.run                       = _run;
+    flat_slice.subrun                    = _subrun;
+    flat_slice.event                     = _event;
+    flat_slice.slice                     = slice;
+    flat_slice.flsmatch_score            = _slc_flsmatch_score[slice];
+    flat_slice.flsmatch_qllx             = _slc_flsmatch_qllx[slice];
+    flat_slice.flsmatch_tpcx             = _slc_flsmatch_tpcx[slice];
+    flat_slice.flsmatch_t0               = _slc_flsmatch_t0[slice];
+    flat_slice.flsmatch_hypoz            = _slc_flsmatch_hypoz[slice];
+    flat_slice.flsmatch_xfixed_chi2      = _slc_flsmatch_xfixed_chi2[slice];
+    flat_slice.flsmatch_xfixed_ll        = _slc_flsmatch_xfixed_ll[slice];
+    flat_slice.flsmatch_cosmic_score     = _slc_flsmatch_cosmic_score[slice];
+    flat_slice.flsmatch_cosmic_t0        = _slc_flsmatch_cosmic_t0[slice];
+    flat_slice.nuvtx_x                   = _slc_nuvtx_x[slice];
+    flat_slice.nuvtx_y                   = _slc_nuvtx_y[slice];
+    flat_slice.nuvtx_z                   = _slc_nuvtx_z[slice];
+    flat_slice.nuvtx_fv                  = _slc_nuvtx_fv[slice];
+    flat_slice.vtxcheck_angle            = _slc_vtxcheck_angle[slice];
+    flat_slice.origin                    = _slc_origin[slice];
+    flat_slice.nhits_u                   = _slc_nhits_u[slice];
+    flat_slice.nhits_v                   = _slc_nhits_v[slice];
+    flat_slice.nhits_w                   = _slc_nhits_w[slice];
+    flat_slice.longesttrack_length       = _slc_longesttrack_length[slice];
+    flat_slice.longesttrack_deadfraction = _slc_longesttrack_deadfraction[slice];
+    flat_slice.acpt_outoftime            = _slc_acpt_outoftime[slice];
+    flat_slice.crosses_top_boundary      = _slc_crosses_top_boundary[slice];
+    flat_slice.nuvtx_closetodeadregion_u = _slc_nuvtx_closetodeadregion_u[slice];
+    flat_slice.nuvtx_closetodeadregion_v = _slc_nuvtx_closetodeadregion_v[slice];
+    flat_slice.nuvtx_closetodeadregion_w = _slc_nuvtx_closetodeadregion_w[slice];
+    flat_slice.kalman_chi2               = _slc_kalman_chi2[slice];
+    flat_slice.kalman_ndof               = _slc_kalman_ndof[slice];
+    flat_slice.passed_min_track_quality  = _slc_passed_min_track_quality[slice];
+    flat_slice.n_intime_pe_closestpmt    = _slc_n_intime_pe_closestpmt[slice];
+    flat_slice.maxdistance_vtxtrack      = _slc_maxdistance_vtxtrack[slice];
+    ubxsec::FillFlatSpec(_slc_flshypo_spec[slice],        flat_slice.flshypo_spec);
+    ubxsec::FillFlatSpec(_slc_flshypo_xfixed_spec[slice], flat_slice.flshypo_xfixed_spec);
+    _flat_slice_writer.Commit();
+  }
+
+  // Beam flashes
+  for (int f = 0; f < _nbeamfls; f++) {
+    ubxsec::FlatFlashRecord & flat_flash = _flat_flash_writer.Get();
+    flat_flash.event_entry  = event_entry;
+    flat_flash.run          = _run;
+    flat_flash.subrun       = _subrun;
+    flat_flash.event        = _event;
+    flat_flash.flash        = f;
+    flat_flash.beamfls_time = _beamfls_time[f];
+    flat_flash.beamfls_pe   = _beamfls_pe[f];
+    flat_flash.beamfls_z    = _beamfls_z[f];
+    ubxsec::FillFlatSpec(_beamfls_spec[f], flat_flash.beamfls_spec);
+    _flat_flash_writer.Commit();
+  }
+}
+
+
+
+//___________________________________________________________________________________________________
+void UBXSec::endJob() {
+
+  _tree_filler.Wait();
+  _flat_event_writer.Flush();
+  _flat_slice_writer.Flush();
+  _flat_flash_writer.Flush();
+}
+
+
+
 DEFINE_ART_MODULE(UBXSec)
+
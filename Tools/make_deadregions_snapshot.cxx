@@ -0,0 +1,45 @@
+////////////////////////////////////////////////////////////////////////
+// File:        make_deadregions_snapshot.cxx
+//
+// Converts the wire geometry and channel status text files used by
+// FindDeadRegions (UseFile mode) into a binary snapshot that can be
+// loaded with the SnapshotFile option.
+//
+// Usage: make_deadregions_snapshot <geometry.txt> <status.txt> <output.bin>
+////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "uboone/UBXSec/Algorithms/DeadRegionsSnapshot.h"
+
+int main(int argc, char** argv) {
+
+  if (argc != 4) {
+    std::cerr << "Usage: " << argv[0] << " <geometry.txt> <status.txt> <output.bin>" << std::endl;
+    return 1;
+  }
+
+  std::vector<unsigned int> wire;
+  std::vector<float> y_start, z_start, y_end, z_end;
+  std::vector<bool> status;
+
+  if (!ubxsec::DeadRegionsSnapshot::ReadGeometryText(argv[1], wire, y_start, z_start, y_end, z_end))
+    return 1;
+
+  if (!ubxsec::DeadRegionsSnapshot::ReadStatusText(argv[2], status))
+    return 1;
+
+  if (!ubxsec::DeadRegionsSnapshot::Write(argv[3], wire, y_start, z_start, y_end, z_end, status))
+    return 1;
+
+  // Check the file can be read back
+  ubxsec::DeadRegionsSnapshot snapshot;
+  if (!snapshot.Open(argv[3]))
+    return 1;
+
+  std::cout << "Written " << argv[3] << " with " << snapshot.NChannels() << " channels." << std::endl;
+
+  return 0;
+}